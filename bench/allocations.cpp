@@ -0,0 +1,93 @@
+/**
+ * @file allocations.cpp
+ * @author Gabriel Gonzalez
+ *
+ * @brief Count the heap allocations of interface::parse(), has() and get(), to
+ *        check that parsing does not allocate beyond the stored values.
+ *
+ * @details A typical command line of 30 arguments is parsed with the results
+ *          in an arena, which must then make no global allocation at all, and
+ *          on the default resource, where only the stored values allocate.
+ *          Lookups by key and by ID must never allocate. Build and run it
+ *          with:
+ *
+ *          g++ -std=c++17 -O2 -I.. allocations.cpp ../commandline.cpp \
+ *              -pthread -o allocations
+ *          ./allocations
+ *
+ *          It returns 0 if every check passes, and 1 otherwise.
+ */
+
+#include "commandline.hpp"
+#include "harness.hpp"
+#include <cstdio>
+#include <memory_resource>
+
+/**
+ * @brief A typical command line, of 30 arguments after the program name.
+ */
+static const char* kArguments[] = {
+    "prog", "-v", "--jobs=8", "-o", "out.txt", "--mode=fast", "-m", "slow",
+    "--ratio=0.5", "-vq", "--timeout=250ms", "--verb", "--input", "a.txt",
+    "b.txt", "c.txt", "d.txt", "e.txt", "-x", "-j", "4", "--define=NAME=value",
+    "--output=final.txt", "-t", "1s", "--retries=3", "-d", "A=1",
+    "--define=B=2", "--dry-run", "-q", NULL
+};
+
+/**
+ * @brief Report a check, and whether it passed.
+ */
+static bool report(const char* name, size_t count, size_t most)
+{
+    bool ok = (count <= most);
+    printf("%-40s %4zu allocations  %s\n", name, count, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(void)
+{
+    commandline::set_program_name("allocations");
+
+    commandline::optlist_t options = make_options();
+    char**                 argv    = const_cast<char**>(kArguments);
+    size_t                 before;
+    int                    failed  = 0;
+
+    /* Everything parse() stores comes from the arena, and the arena cannot
+     * fall back to the heap. */
+    static char                         buffer[1 << 16];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+        std::pmr::null_memory_resource());
+    commandline::interface              cli(options, &arena);
+
+    before = allocations;
+    cli.parse(argv);
+    failed += !report("parse, arena", allocations - before, 0);
+
+    commandline::errors_t errors;
+    cli.reset();
+    before = allocations;
+    cli.parse(argv, errors);
+    failed += !report("parse with errors, arena", allocations - before, 0);
+    failed += (errors.count != 0);
+
+    before = allocations;
+    commandline::optid_t jobs = cli.id("jobs");
+    bool                 has  = cli.has("verbose") && cli.has(jobs);
+    bool                 get  = (cli.get<int>("jobs") == 8)
+        && (cli.get<int>(jobs) == 8) && (cli.get(jobs) == "8");
+    failed += !report("id, has and get, by key and by ID",
+                      allocations - before, 0);
+    failed += !has || !get;
+
+    /* On the default resource, only the stored values allocate: each value
+     * too long for a short string, and the growth of each list of values.
+     * That is at most two allocations per argument. */
+    commandline::interface heap(options);
+    before = allocations;
+    heap.parse(argv);
+    failed += !report("parse, default resource", allocations - before,
+                      2 * (sizeof(kArguments) / sizeof(*kArguments) - 2));
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file bench.cpp
+ * @author Gabriel Gonzalez
+ *
+ * @brief Benchmark interface::parse(), get(), has() and usage().
+ *
+ * @details Parsing is measured with 10, 100 and 1000 options, on command lines
+ *          of 1 to 100000 arguments, and on a list_argument type option with
+ *          many values. Each case reports the time per token, which includes
+ *          reset() between parses, and the number of global allocations of a
+ *          first parse, on a new interface, and of each parse after it, whose
+ *          results keep their capacity. Allocations are counted by replacing
+ *          operator new. Lookups are measured by key and by ID, and the usage
+ *          message is rendered for each option count. Build and run it with:
+ *
+ *          g++ -std=c++17 -O2 -I.. bench.cpp ../commandline.cpp \
+ *              -pthread -o bench
+ *          ./bench
+ */
+
+#include "commandline.hpp"
+#include "harness.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/**
+ * @brief Fewest tokens parsed by each case, so that short command lines are
+ *        parsed many times.
+ */
+static const size_t kTokens = 1000000;
+
+/**
+ * @brief Keeps the results of lookups from being optimised away.
+ */
+static volatile size_t sink = 0;
+
+/**
+ * @brief Build a number of options, one in three of which is a flag, and the
+ *        last of which takes a list of values.
+ */
+static commandline::optlist_t make_options(size_t count)
+{
+    commandline::optlist_t options;
+    for (size_t i=0; i < count; ++i)
+    {
+        bool        flag = (i % 3 == 0);
+        std::string shortopt;
+        if (i < 26)
+        {
+            shortopt = std::string("-") + static_cast<char>('a' + i);
+        }
+        options.push_back({shortopt, "--option-" + std::to_string(i),
+                           flag ? "" : "VALUE",
+                           flag ? commandline::no_argument :
+                               commandline::required_argument,
+                           "Option number " + std::to_string(i) + "."});
+    }
+    options.back().argument = commandline::list_argument;
+    return options;
+}
+
+/**
+ * @brief Build a command line of mixed options, spread over all of them.
+ */
+static void make_command(command& line, const commandline::optlist_t& options,
+                         size_t size)
+{
+    line.args = {"bench"};
+    for (size_t i=0; line.args.size() <= size; ++i)
+    {
+        const commandline::option_t& data =
+            options[(i * 7919) % (options.size() - 1)];
+        if (data.argument == commandline::no_argument)
+        {
+            line.args.push_back(data.longopt);
+        }
+        else
+        {
+            line.args.push_back(data.longopt + "=value");
+        }
+    }
+}
+
+/**
+ * @brief Parse a command line repeatedly, and report the time per token and
+ *        the allocations per parse.
+ */
+static void parse(const char* name, const commandline::catalog_t& catalog,
+                  command& line)
+{
+    char** argv   = line.data();
+    size_t tokens = line.args.size() - 1;
+    size_t runs   = std::max<size_t>(kTokens / std::max<size_t>(tokens, 1), 3);
+
+    commandline::interface cli(catalog);
+    size_t before = allocations;
+    cli.parse(argv);
+    size_t first  = allocations - before;
+
+    before = allocations;
+    auto   start  = std::chrono::steady_clock::now();
+    for (size_t run=0; run < runs; ++run)
+    {
+        cli.reset();
+        cli.parse(argv);
+    }
+    auto   stop   = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    printf("%-26s %7zu tokens %8.1f ns/token %7zu allocations first "
+           "%7.1f after\n", name, tokens,
+           ns / static_cast<double>(runs * std::max<size_t>(tokens, 1)),
+           first, static_cast<double>(allocations - before)
+               / static_cast<double>(runs));
+}
+
+/**
+ * @brief Time a lookup repeatedly, and report the time per call.
+ */
+template <typename F>
+static void lookup(const char* name, F call)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0; i < kTokens; ++i)
+    {
+        sink = sink + call(i);
+    }
+    auto stop  = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    printf("%-26s %8.1f ns/call\n", name, ns / kTokens);
+}
+
+int main(void)
+{
+    commandline::set_program_name("bench");
+
+    for (size_t count : {10, 100, 1000})
+    {
+        commandline::optlist_t options = make_options(count);
+        commandline::catalog_t catalog =
+            std::make_shared<const commandline::catalog>(options);
+        commandline::interface cli(catalog);
+        command                line;
+
+        for (size_t size : {1, 10, 100, 1000, 10000, 100000})
+        {
+            std::string name = "parse, " + std::to_string(count)
+                + " options";
+            make_command(line, options, size);
+            parse(name.c_str(), catalog, line);
+        }
+
+        std::string name = "parse list, " + std::to_string(count)
+            + " options";
+        line.args = {"bench", options.back().longopt};
+        line.args.resize(100001, "value");
+        parse(name.c_str(), catalog, line);
+
+        make_command(line, options, 100);
+        cli.reset();
+        cli.parse(line.data());
+
+        std::vector<std::string>          keys;
+        std::vector<commandline::optid_t> ids;
+        for (const commandline::option_t& data : options)
+        {
+            keys.push_back(data.longopt.substr(2));
+            ids.push_back(cli.id(keys.back()));
+        }
+
+        name = "has by key, " + std::to_string(count) + " options";
+        lookup(name.c_str(), [&](size_t i)
+            {
+                return cli.has(keys[i % count]);
+            });
+        name = "has by ID, " + std::to_string(count) + " options";
+        lookup(name.c_str(), [&](size_t i)
+            {
+                return cli.has(ids[i % count]);
+            });
+        name = "get by key, " + std::to_string(count) + " options";
+        lookup(name.c_str(), [&](size_t i)
+            {
+                return cli.get(keys[i % count]).size();
+            });
+        name = "get by ID, " + std::to_string(count) + " options";
+        lookup(name.c_str(), [&](size_t i)
+            {
+                return cli.get(ids[i % count]).size();
+            });
+
+        /* The message is kept once rendered, so render it on a new
+         * interface each time, sharing the same catalog. */
+        size_t runs  = 100000 / count;
+        double ns    = 0;
+        size_t bytes = 0;
+        for (size_t run=0; run < runs; ++run)
+        {
+            commandline::interface help(catalog);
+            auto start = std::chrono::steady_clock::now();
+            bytes += help.usage_text().size();
+            auto stop  = std::chrono::steady_clock::now();
+            ns += std::chrono::duration<double, std::nano>(stop - start)
+                .count();
+        }
+        printf("%-26s %8.1f ns/option %7zu bytes\n",
+               ("usage, " + std::to_string(count) + " options").c_str(),
+               ns / static_cast<double>(runs * count), bytes / runs);
+    }
+    return 0;
+}
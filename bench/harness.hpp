@@ -0,0 +1,145 @@
+/**
+ * @file harness.hpp
+ * @author Gabriel Gonzalez
+ *
+ * @brief What the benchmarks and checks share: counting of heap allocations,
+ *        command lines that own their arguments, and a typical set of options.
+ *
+ * @details The global operator new and delete are replaced here, so this
+ *          header must be included by only one source file of a program.
+ */
+
+#ifndef COMMAND_LINE_BENCH_HARNESS_HPP
+#define COMMAND_LINE_BENCH_HARNESS_HPP
+
+#include "commandline.hpp"
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Number of calls to the global operator new.
+ */
+static size_t allocations = 0;
+
+/**
+ * @brief Bytes allocated through the global operator new.
+ */
+static size_t allocated = 0;
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    allocated += size;
+    if (void* p = malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+/* The default memory resource allocates with an alignment. */
+void* operator new(size_t size, std::align_val_t align)
+{
+    ++allocations;
+    allocated += size;
+    size_t alignment = static_cast<size_t>(align);
+    if (void* p = aligned_alloc(alignment,
+                                (size + alignment - 1) / alignment * alignment))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+/* GCC warns of a mismatch if it sees operator delete call free() on memory
+ * from operator new, so the replacements are not inlined. */
+#if defined(__GNUC__)
+#define COMMAND_LINE_BENCH_NOINLINE __attribute__((noinline))
+#else
+#define COMMAND_LINE_BENCH_NOINLINE
+#endif
+
+COMMAND_LINE_BENCH_NOINLINE
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+COMMAND_LINE_BENCH_NOINLINE
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+COMMAND_LINE_BENCH_NOINLINE
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    free(p);
+}
+
+COMMAND_LINE_BENCH_NOINLINE
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    free(p);
+}
+
+/**
+ * @brief A command line, owning its arguments.
+ */
+struct command
+{
+    std::vector<std::string> args;
+    std::vector<char*>       argv;
+    size_t                   bytes = 0;
+
+    /**
+     * @brief Build the NULL terminated argument vector, and count its bytes.
+     */
+    char** data(void)
+    {
+        this->argv.clear();
+        this->bytes = 0;
+        for (std::string& arg : this->args)
+        {
+            this->argv.push_back(&arg[0]);
+            this->bytes += arg.size() + 1;
+        }
+        this->argv.push_back(NULL);
+        return this->argv.data();
+    }
+};
+
+/**
+ * @brief Build a typical set of options, with every argument and value type.
+ *        '--verbose', '--verify' and '--version' share prefixes, for
+ *        abbreviations.
+ */
+inline commandline::optlist_t make_options(void)
+{
+    commandline::optlist_t options = {
+        {"-v", "--verbose", "", commandline::no_argument, "Verbose."},
+        {"-q", "--quiet", "", commandline::no_argument, "Quiet."},
+        {"-x", "--extra", "", commandline::no_argument, "Extra."},
+        {"-j", "--jobs", "N", commandline::required_argument, "Jobs.",
+         commandline::integer_value},
+        {"-o", "--output", "FILE", commandline::required_argument, "Output."},
+        {"-m", "--mode", "MODE", commandline::required_argument, "Mode."},
+        {"-r", "--ratio", "R", commandline::required_argument, "Ratio.",
+         commandline::floating_value},
+        {"-t", "--timeout", "T", commandline::required_argument, "Timeout.",
+         commandline::duration_value},
+        {"", "--retries", "N", commandline::required_argument, "Retries.",
+         commandline::integer_value},
+        {"-d", "--define", "NAME=VALUE", commandline::required_argument,
+         "Define."},
+        {"", "--dry-run", "", commandline::no_argument, "Dry run."},
+        {"-i", "--input", "FILE", commandline::list_argument, "Inputs."},
+        {"", "--verify", "", commandline::no_argument, "Verify."},
+        {"", "--version", "", commandline::no_argument, "Version."},
+    };
+    return options;
+}
+
+#endif /* COMMAND_LINE_BENCH_HARNESS_HPP */
@@ -0,0 +1,2927 @@
+/**
+ * @file commandline-inl.hpp
+ * @author Gabriel Gonzalez
+ * 
+ * @brief The definitions of the command line interface utility, compiled once
+ *        by commandline.cpp, or inline in every program that includes
+ *        commandline.hpp in header-only mode.
+ */
+
+#ifndef COMMAND_LINE_INL_HPP
+#define COMMAND_LINE_INL_HPP
+
+#include "commandline.hpp"
+
+/* In header-only mode, this file is included at the end of the header, and
+ * every definition is inline. */
+#ifdef COMMANDLINE_HEADER_ONLY
+#define COMMANDLINE_INLINE inline
+#else
+#define COMMANDLINE_INLINE
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef COMMANDLINE_STATS
+#define COMMANDLINE_COUNT(counter, n) ((counter) += (n))
+#define COMMANDLINE_TIME(timing) stats_timer timer_(timing)
+#define COMMANDLINE_PROBES(counters) stats_probes probes_(counters)
+#define COMMANDLINE_PROBE() \
+    ((probe_stats() != NULL) ? (void)++probe_stats()->probes : (void)0)
+#else
+#define COMMANDLINE_COUNT(counter, n) ((void)0)
+#define COMMANDLINE_TIME(timing) ((void)0)
+#define COMMANDLINE_PROBES(counters) ((void)0)
+#define COMMANDLINE_PROBE() ((void)0)
+#endif
+
+namespace commandline
+{
+    /**
+     * @details The pool is reserved for every string up front, and strings
+     *          that are equal are stored once. The strings needed to parse
+     *          come first, and the descriptions after all of them. Views are
+     *          only taken once the pool is complete.
+     */
+    COMMANDLINE_INLINE
+    catalog::catalog(const optlist_t& options)
+    {
+        std::unordered_map<std::string_view, size_t> interned;
+        std::vector<size_t>                          offsets;
+        size_t                                       size = 0;
+
+        for (const option_t& data : options)
+        {
+            size += data.shortopt.size() + data.longopt.size()
+                + data.name.size() + data.desc.size();
+            for (const std::string& choice : data.choices)
+            {
+                size += choice.size();
+            }
+        }
+
+        auto intern = [&](const std::string& field)
+            {
+                auto it = interned.emplace(field, this->m_pool.size());
+                if (it.second)
+                {
+                    this->m_pool.append(field);
+                }
+                offsets.push_back(it.first->second);
+            };
+
+        this->m_pool.reserve(size);
+        offsets.reserve(4*options.size());
+        for (const option_t& data : options)
+        {
+            intern(data.shortopt);
+            intern(data.longopt);
+            intern(data.name);
+        }
+        for (const option_t& data : options)
+        {
+            for (const std::string& choice : data.choices)
+            {
+                intern(choice);
+            }
+        }
+        for (const option_t& data : options)
+        {
+            intern(data.desc);
+        }
+
+        std::string_view pool(this->m_pool);
+        size_t           n = options.size();
+        size_t           next = 3*n;
+        bool             constrained = false;
+        this->m_flags = (n > 0);
+        this->m_options.reserve(n);
+        this->m_descs.reserve(n);
+        for (size_t i=0; i < n; ++i)
+        {
+            const option_t& data = options[i];
+            this->m_options.push_back({
+                pool.substr(offsets[3*i],   data.shortopt.size()),
+                pool.substr(offsets[3*i+1], data.longopt.size()),
+                pool.substr(offsets[3*i+2], data.name.size()),
+                data.argument,
+                data.type});
+            this->m_flags = this->m_flags
+                && (data.argument == commandline::no_argument);
+            for (const std::string& choice : data.choices)
+            {
+                this->m_choices.push_back(pool.substr(offsets[next++],
+                                                      choice.size()));
+            }
+            constrained = constrained || !data.conflicts.empty()
+                || !data.depends.empty() || !data.choices.empty()
+                || (data.minimum > -std::numeric_limits<double>::infinity())
+                || (data.maximum < std::numeric_limits<double>::infinity())
+                || (data.min_values > 0) || (data.max_values != kNoOption);
+        }
+        for (size_t i=0; i < n; ++i)
+        {
+            this->m_descs.push_back(pool.substr(offsets[next++],
+                                                options[i].desc.size()));
+        }
+
+        this->m_data = this->m_options.data();
+        this->m_desc = this->m_descs.data();
+        this->m_size = n;
+        this->m_words = (n + 63) / 64;
+        if (constrained)
+        {
+            this->compile(options);
+        }
+    }
+
+    /**
+     * @details Any option string or key names an option, the first option
+     *          taking precedence when two share a name. A conflict is
+     *          symmetric, so it is set in the row of both options.
+     */
+    COMMANDLINE_INLINE
+    void catalog::compile(const optlist_t& options)
+    {
+        std::unordered_map<std::string_view, size_t> names;
+        size_t                                       n = this->m_size;
+        for (size_t i=0; i < n; ++i)
+        {
+            std::string_view shortopt = this->m_options[i].shortopt;
+            std::string_view longopt  = this->m_options[i].longopt;
+            if (!longopt.empty())
+            {
+                names.emplace(longopt, i);
+                names.emplace(longopt.substr(2), i);
+            }
+            if (!shortopt.empty())
+            {
+                names.emplace(shortopt, i);
+                names.emplace(shortopt.substr(1), i);
+            }
+        }
+
+        auto resolve = [&](const std::string& name)
+            {
+                auto it = names.find(name);
+                if (it == names.end())
+                {
+                    fprintf(stderr,
+                            "%s: Constraint names unknown option '%s'.\n",
+                            program_name(), name.c_str());
+                    exit(1);
+                }
+                return it->second;
+            };
+
+        size_t words = this->m_words;
+        size_t first = 0;
+        this->m_conflicts.assign(n*words, 0);
+        this->m_depends.assign(n*words, 0);
+        this->m_rules.reserve(n);
+        for (size_t i=0; i < n; ++i)
+        {
+            const option_t& data = options[i];
+            for (const std::string& name : data.conflicts)
+            {
+                size_t j = resolve(name);
+                this->m_conflicts[i*words + j/64] |= uint64_t(1) << (j%64);
+                this->m_conflicts[j*words + i/64] |= uint64_t(1) << (i%64);
+            }
+            for (const std::string& name : data.depends)
+            {
+                size_t j = resolve(name);
+                this->m_depends[i*words + j/64] |= uint64_t(1) << (j%64);
+            }
+
+            this->m_rules.push_back({data.minimum, data.maximum,
+                                     data.min_values, data.max_values,
+                                     first, data.choices.size()});
+            first += data.choices.size();
+        }
+    }
+
+#ifdef COMMANDLINE_STATS
+    /**
+     * @class stats_timer
+     * 
+     * @brief Add the time from its construction to its destruction to a phase
+     *        timing.
+     */
+    class stats_timer
+    {
+    public:
+        explicit stats_timer(std::chrono::nanoseconds& timing)
+            : m_timing(timing),
+              m_start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~stats_timer(void)
+        {
+            this->m_timing += std::chrono::steady_clock::now() - this->m_start;
+        }
+
+    private:
+        std::chrono::nanoseconds&             m_timing;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /**
+     * @brief Retrieve the statistics that option lookups are counted in, on
+     *        this thread, or NULL when no parse is running. The lookups are
+     *        const, and may run on many threads at once, so they cannot
+     *        count in the interface itself.
+     */
+    COMMANDLINE_INLINE
+    stats_t*& probe_stats(void)
+    {
+        static thread_local stats_t* counters = NULL;
+        return counters;
+    }
+
+    /**
+     * @class stats_probes
+     * 
+     * @brief Count the option lookups made on this thread, from its
+     *        construction to its destruction, in the given statistics.
+     */
+    class stats_probes
+    {
+    public:
+        explicit stats_probes(stats_t& counters)
+            : m_previous(probe_stats())
+        {
+            probe_stats() = &counters;
+        }
+
+        ~stats_probes(void)
+        {
+            probe_stats() = this->m_previous;
+        }
+
+    private:
+        stats_t* m_previous;
+    };
+#endif
+
+    /**
+     * @brief Retrieve the storage of the program name, which is shared by
+     *        every translation unit in header-only mode.
+     */
+    COMMANDLINE_INLINE
+    std::atomic<const char*>& program_storage(void)
+    {
+#ifdef PROGRAM
+        static std::atomic<const char*> name(PROGRAM);
+#else
+        static std::atomic<const char*> name("program");
+#endif
+        return name;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void set_program_name(const char* name)
+    {
+        program_storage().store(name);
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    const char* program_name(void)
+    {
+        return program_storage().load();
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    interface::interface(const optlist_t& options,
+                         std::pmr::memory_resource* resource)
+        : interface(std::make_shared<const catalog>(options), resource)
+    {
+    }
+
+    /**
+     * @details Index both the short and long form of every option. Options
+     *          listed first take precedence when two of them share a string,
+     *          the same as a linear search would.
+     */
+    COMMANDLINE_INLINE
+    interface::interface(catalog_t options,
+                         std::pmr::memory_resource* resource)
+        : m_catalog(std::move(options)),
+          m_options(*m_catalog),
+          m_lookup(NULL),
+          m_dashed(true),
+          m_results(m_options.size(), resource),
+          m_present((m_options.size() + 63) / 64, 0)
+    {
+        this->index();
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    interface::interface(const optlist_t& options, std::string_view image,
+                         std::pmr::memory_resource* resource)
+        : interface(options, resource)
+    {
+        if (!this->deserialize(image))
+        {
+            fprintf(stderr, "%s: Invalid image of parse results.\n",
+                    program_name());
+            exit(1);
+        }
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    interface::interface(const interface& other)
+        : m_catalog(other.m_catalog),
+          m_options(*m_catalog),
+          m_lookup(other.m_lookup),
+          m_dashed(other.m_dashed),
+          m_limits(other.m_limits),
+          m_usage(other.m_usage),
+          m_helpfile(other.m_helpfile),
+          m_results(other.m_results),
+          m_present(other.m_present),
+          m_index(other.m_index),
+          m_keys(other.m_keys),
+          m_prefixes(other.m_prefixes),
+          m_shorts(other.m_shorts)
+    {
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    interface::interface(catalog_t options, const lookup_t* lookup,
+                         std::pmr::memory_resource* resource)
+        : m_catalog(std::move(options)),
+          m_options(*m_catalog),
+          m_lookup(lookup),
+          m_dashed(true),
+          m_results(m_options.size(), resource),
+          m_present((m_options.size() + 63) / 64, 0)
+    {
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void interface::usage(void)
+    {
+        std::string_view text = this->usage_text();
+
+        fflush(stdout);
+        write_all(STDOUT_FILENO, text);
+    }
+
+    /**
+     * @details Each option is listed as '-s, --long=<name>', followed by its
+     *          description on the next line. An option with only a short form
+     *          is listed as '-s <name>'. Descriptions from the help file, if
+     *          there is one, replace those of the catalog.
+     */
+    COMMANDLINE_INLINE
+    std::string_view interface::usage_text(void)
+    {
+        if (!this->m_usage.empty())
+        {
+            return this->m_usage;
+        }
+
+        std::vector<std::string> help;
+        std::string&             text  = this->m_usage;
+        size_t                   width = 0;
+        size_t                   size  = 0;
+
+        if (!this->m_helpfile.empty())
+        {
+            this->load_help(help);
+        }
+
+        for (size_t i=0; i < this->m_options.size(); ++i)
+        {
+            const option_info_t& data = this->m_options[i];
+            width = std::max(width, data.shortopt.size());
+            size += data.shortopt.size() + data.longopt.size()
+                + data.name.size() + this->m_options.desc(i).size() + 32;
+        }
+
+        text.reserve(size + 64);
+        text.append("Usage: ").append(program_name())
+            .append(" [option]...\n\n");
+        text.append("Options:");
+
+        for (size_t i=0; i < this->m_options.size(); ++i)
+        {
+            const option_info_t& data = this->m_options[i];
+            std::string_view     desc = this->m_options.desc(i);
+            if ((i < help.size()) && !help[i].empty())
+            {
+                desc = help[i];
+            }
+
+            text.append("\n    ").append(data.shortopt);
+            if (data.longopt.empty())
+            {
+                if (!data.name.empty())
+                {
+                    text.append(" <").append(data.name).append(">");
+                }
+            }
+            else
+            {
+                text.append(data.shortopt.empty() ? "  " : ", ");
+                text.append(width-data.shortopt.size(), ' ');
+                text.append(data.longopt);
+                if (!data.name.empty())
+                {
+                    text.append("=<").append(data.name).append(">");
+                }
+            }
+            text.append("\n        ").append(desc).append("\n");
+        }
+
+        return text;
+    }
+
+    /**
+     * @brief Whitespace, which is trimmed from the lines of config and help
+     *        files.
+     */
+    const char kSpace[] = " \t\r\n";
+
+    /**
+     * @brief Read a file one line at a time, into a single line buffer that
+     *        is grown as needed by getline(), and hand each line that is not
+     *        blank or a comment, i.e. that starts with '#', to a function,
+     *        without its leading and trailing whitespace.
+     * 
+     * @param[in] path    Path of the file.
+     * @param[in] handler Function called with each line, as a view into the
+     *                    line buffer.
+     * 
+     * @return true if the file was read. Otherwise, return false.
+     */
+    template <typename F>
+    bool read_lines(const char* path, F handler)
+    {
+        FILE*   file = fopen(path, "r");
+        char*   line = NULL;
+        size_t  size = 0;
+        ssize_t n;
+
+        if (!file)
+        {
+            return false;
+        }
+
+        while ((n=getline(&line, &size, file)) >= 0)
+        {
+            std::string_view text(line, static_cast<size_t>(n));
+            size_t           begin = text.find_first_not_of(kSpace);
+            if ((begin == std::string_view::npos) || (text[begin] == '#'))
+            {
+                continue;
+            }
+            handler(text.substr(begin,
+                                text.find_last_not_of(kSpace)+1-begin));
+        }
+
+        free(line);
+        fclose(file);
+        return true;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void interface::set_help_file(std::string_view path)
+    {
+        this->m_helpfile = path;
+        this->m_usage.clear();
+    }
+
+    /**
+     * @details Each line is of the form 'key description', where the key is
+     *          that of an option. Blank lines, lines that start with '#', and
+     *          lines with an unknown key are skipped.
+     */
+    COMMANDLINE_INLINE
+    void interface::load_help(std::vector<std::string>& help) const
+    {
+        help.resize(this->m_options.size());
+        read_lines(this->m_helpfile.c_str(),
+                   [this, &help](std::string_view text)
+            {
+                size_t  split = std::min(text.find_first_of(kSpace),
+                                         text.size());
+                optid_t id    = this->id(text.substr(0, split));
+                if (id == kNoOption)
+                {
+                    return;
+                }
+
+                text.remove_prefix(split);
+                text.remove_prefix(std::min(text.find_first_not_of(kSpace),
+                                            text.size()));
+                help[id] = text;
+            });
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    std::vector<std::string_view>
+    interface::completions(std::string_view prefix) const
+    {
+        std::vector<std::string_view> matches;
+
+        if ((prefix.size() > 2) && (prefix.substr(0, 2) == "--")
+            && this->m_prefixes)
+        {
+            prefix_range_t range = this->find_prefix(prefix);
+            matches.reserve(range.second - range.first);
+            for (const prefix_t* it=range.first; it != range.second; ++it)
+            {
+                matches.push_back(it->first);
+            }
+            return matches;
+        }
+
+        for (size_t i=0; i < this->m_options.size(); ++i)
+        {
+            const option_info_t& data = this->m_options[i];
+            if (!data.shortopt.empty()
+                && (data.shortopt.substr(0, prefix.size()) == prefix))
+            {
+                matches.push_back(data.shortopt);
+            }
+            if (!data.longopt.empty()
+                && (data.longopt.substr(0, prefix.size()) == prefix))
+            {
+                matches.push_back(data.longopt);
+            }
+        }
+        return matches;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool interface::complete(char** argv) const
+    {
+        if ((*argv == NULL) || (argv[1] == NULL))
+        {
+            return false;
+        }
+
+        std::string_view mode(argv[1]);
+        std::string_view word((argv[2] != NULL) ? argv[2] : "");
+        std::string      text;
+        if (mode == "--complete")
+        {
+            for (std::string_view match : this->completions(word))
+            {
+                text.append(match).push_back('\n');
+            }
+        }
+        else if ((mode == "--completion-script") && (word == "bash"))
+        {
+            this->completion_script(bash_shell, text);
+        }
+        else if ((mode == "--completion-script") && (word == "zsh"))
+        {
+            this->completion_script(zsh_shell, text);
+        }
+        else
+        {
+            return false;
+        }
+
+        fflush(stdout);
+        write_all(STDOUT_FILENO, text);
+        return true;
+    }
+
+    /**
+     * @details The script completes the program name without its directory,
+     *          as the program is looked up in PATH, or run from anywhere. The
+     *          name of the completion function is that name, with any
+     *          character that is not allowed in it replaced by '_'. In the
+     *          zsh script, descriptions and argument names are quoted, and
+     *          the characters that '_arguments' treats specially are escaped.
+     *          Each option is given the argument forms that parse() accepts.
+     */
+    COMMANDLINE_INLINE
+    void interface::completion_script(shell_t shell, std::string& script) const
+    {
+        std::string_view program(program_name());
+        size_t           slash = program.rfind('/');
+        if (slash != std::string_view::npos)
+        {
+            program.remove_prefix(slash+1);
+        }
+
+        std::string function("_");
+        for (char c : program)
+        {
+            function.push_back(isalnum(static_cast<unsigned char>(c)) ?
+                               c : '_');
+        }
+
+        if (shell == bash_shell)
+        {
+            script.append(function).append("()\n{\n");
+            script.append("    local cur=\"${COMP_WORDS[COMP_CWORD]}\"\n");
+            script.append("    COMPREPLY=($(compgen -W \"");
+            for (std::string_view match : this->completions(""))
+            {
+                script.append(match).push_back(' ');
+            }
+            if (script.back() == ' ')
+            {
+                script.pop_back();
+            }
+            script.append("\" -- \"$cur\"))\n}\n");
+            script.append("complete -F ").append(function).append(" ")
+                .append(program).append("\n");
+            return;
+        }
+
+        /* Quote for the shell, and escape what '_arguments' treats
+         * specially, in descriptions and in argument names. */
+        auto escape = [](std::string& spec, std::string_view text)
+            {
+                for (char c : text)
+                {
+                    if (c == '\'')
+                    {
+                        spec.append("'\\''");
+                        continue;
+                    }
+                    if ((c == '[') || (c == ']') || (c == ':') || (c == '\\'))
+                    {
+                        spec.push_back('\\');
+                    }
+                    spec.push_back(c);
+                }
+            };
+
+        script.append("#compdef ").append(program).append("\n\n");
+        script.append(function).append("()\n{\n    _arguments");
+        for (size_t i=0; i < this->m_options.size(); ++i)
+        {
+            const option_info_t& data = this->m_options[i];
+            std::string          spec("[");
+            escape(spec, this->m_options.desc(i));
+            spec.push_back(']');
+            switch (data.argument)
+            {
+            case no_argument:
+                break;
+            case optional_argument:
+                spec.append("::");
+                break;
+            case list_argument:
+                /* Every word up to the next option is a value. */
+                spec.append(":*-*:");
+                break;
+            case required_argument:
+            default:
+                spec.append(":");
+                break;
+            }
+            if (data.argument != no_argument)
+            {
+                escape(spec, data.name);
+                spec.append(": ");
+            }
+
+            for (std::string_view option : {data.shortopt, data.longopt})
+            {
+                if (option.empty())
+                {
+                    continue;
+                }
+
+                /* A long option takes its argument after '=', in the same
+                 * word, and a short option in the same word or the next. The
+                 * values of a list always follow as words of their own. */
+                script.append(" \\\n        '").append(option);
+                if ((data.argument != no_argument)
+                    && (data.argument != list_argument))
+                {
+                    bool dashed = (option.size() > 2)
+                        && (option.substr(0, 2) == "--");
+                    script.append(dashed ? "=-" : "+");
+                }
+                script.append(spec).append("'");
+            }
+        }
+        script.append("\n}\n\n").append(function).append(" \"$@\"\n");
+    }
+
+    /**
+     * @details Feed every argument to a stream, which stores each option and
+     *          value as soon as it is recognised.
+     */
+    COMMANDLINE_INLINE
+    void interface::parse(char** argv)
+    {
+        stream input(*this, [this](const event_t& event)
+            {
+                this->parse_event(event, NULL);
+            });
+
+        this->parse_stream(input, argv, NULL);
+        this->check(NULL);
+    }
+
+    /**
+     * @details The stream counts tokens from argv+1, so each error index is
+     *          shifted by one to be a position in argv.
+     */
+    COMMANDLINE_INLINE
+    size_t interface::parse(char** argv, errors_t& errors)
+    {
+        errors.count = 0;
+
+        stream input(*this, [this, &errors](const event_t& event)
+            {
+                this->parse_event(event, &errors);
+            }, &errors);
+
+        this->parse_stream(input, argv, &errors);
+
+        size_t size = std::min(errors.count, kMaxErrors);
+        for (size_t i=0; i < size; ++i)
+        {
+            ++errors.list[i].index;
+        }
+
+        /* Constraints are about the whole command line, at index 0. */
+        this->check(&errors);
+        return errors.count;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void interface::parse_stream(stream& input, char** argv, errors_t* errors)
+    {
+#ifdef COMMANDLINE_STATS
+        this->m_stats = stats_t();
+#endif
+
+        if ((*argv == NULL)
+            || (this->m_options.flags() && this->parse_flags(argv+1, errors)))
+        {
+            return;
+        }
+
+        input.feed(argv+1);
+        input.finish();
+
+#ifdef COMMANDLINE_STATS
+        this->m_stats.add(input.stats());
+#endif
+    }
+
+    /**
+     * @brief Most arguments that parse_flags() handles, so that the IDs it
+     *        looks up fit in a fixed array on the stack.
+     */
+    const size_t kFlagArguments = 64;
+
+    /**
+     * @details Every argument is looked up once to check that it is exactly
+     *          the short or long form of a flag, and its ID is kept. Anything
+     *          else, such as a cluster, an abbreviation, a response file or a
+     *          value after '=', is left to the stream, and so is a command line
+     *          of more than kFlagArguments arguments, or one that could be
+     *          over a limit. Only then are the flags stored, in order, so that
+     *          a help option exits at the same point as in the stream.
+     */
+    COMMANDLINE_INLINE
+    bool interface::parse_flags(char** argv, errors_t* errors)
+    {
+        std::array<optid_t, kFlagArguments> ids;
+        size_t                              count = 0;
+
+        COMMANDLINE_PROBES(this->m_stats);
+
+        for (char** argp=argv; *argp != NULL; ++argp, ++count)
+        {
+            if ((count == ids.size()) || ((*argp)[0] == '@')
+                || ((ids[count]=this->find_index(*argp)) == kNoOption))
+            {
+                return false;
+            }
+        }
+
+        if ((count > this->m_limits.tokens) || (count > this->m_limits.values))
+        {
+            return false;
+        }
+
+        COMMANDLINE_COUNT(this->m_stats.tokens, count);
+        for (size_t i=0; i < count; ++i)
+        {
+            if (!errors)
+            {
+                this->parse_help_option(&this->m_options[ids[i]]);
+            }
+            this->store(ids[i], "");
+        }
+        return true;
+    }
+
+    /**
+     * @details The options that are set, from any layer, are already in a
+     *          bitset, so that each constraint between options is a few word
+     *          operations on the rows of the catalog. A conflict is only
+     *          between two options entered on the command line, so that a
+     *          default, config or environment value gives way to an option
+     *          entered against it, while a dependency can be met by a value
+     *          from any layer. The rules of each option that is set are
+     *          checked in the same pass. A range only applies to integer and
+     *          floating point values.
+     */
+    COMMANDLINE_INLINE
+    void interface::check(errors_t* errors) const
+    {
+        if (!this->m_options.constrained())
+        {
+            return;
+        }
+
+        size_t                       n       = this->m_options.size();
+        size_t                       words   = this->m_options.words();
+        const std::vector<uint64_t>& present = this->m_present;
+
+        for (optid_t id=0; id < n; ++id)
+        {
+            if (!this->has(id))
+            {
+                continue;
+            }
+
+            const uint64_t* conflicts = this->m_options.conflicts(id);
+            const uint64_t* depends   = this->m_options.depends(id);
+            bool            entered   =
+                (this->m_results[id].layer == command_layer);
+            for (size_t w=0; w < words; ++w)
+            {
+                /* Each conflict is in both rows, report it once. */
+                for (uint64_t bits=entered ? conflicts[w] & present[w] : 0;
+                     bits; bits &= bits - 1)
+                {
+                    optid_t other = w*64;
+                    while (!((bits >> (other%64)) & 1))
+                    {
+                        ++other;
+                    }
+                    if ((other > id)
+                        && (this->m_results[other].layer == command_layer))
+                    {
+                        this->violate(errors, conflicting_options, id, other,
+                                      "");
+                    }
+                }
+                for (uint64_t bits=depends[w] & ~present[w]; bits;
+                     bits &= bits - 1)
+                {
+                    optid_t other = w*64;
+                    while (!((bits >> (other%64)) & 1))
+                    {
+                        ++other;
+                    }
+                    this->violate(errors, missing_requirement, id, other, "");
+                }
+            }
+
+            const rules_t& rules  = this->m_options.rules(id);
+            const auto&    values = this->m_results[id].values;
+            if ((values.size() < rules.min_values)
+                || (values.size() > rules.max_values))
+            {
+                this->violate(errors, wrong_value_count, id, kNoOption, "");
+            }
+
+            value_t type = this->m_options[id].type;
+            bool    ranged = ((type == integer_value)
+                              || (type == floating_value))
+                && ((rules.minimum > -std::numeric_limits<double>::infinity())
+                    || (rules.maximum < std::numeric_limits<double>::infinity()));
+            for (std::string_view value : values)
+            {
+                if (rules.choices > 0)
+                {
+                    size_t i = 0;
+                    while ((i < rules.choices)
+                           && (this->m_options.choice(rules.first_choice+i)
+                               != value))
+                    {
+                        ++i;
+                    }
+                    if (i == rules.choices)
+                    {
+                        this->violate(errors, invalid_choice, id, kNoOption,
+                                      value);
+                    }
+                }
+
+                typedval_t converted;
+                if (ranged && this->convert(type, value, converted))
+                {
+                    double number = (type == integer_value) ?
+                        static_cast<double>(std::get<long long>(converted)) :
+                        std::get<double>(converted);
+                    if ((number < rules.minimum) || (number > rules.maximum))
+                    {
+                        this->violate(errors, out_of_range, id, kNoOption,
+                                      value);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @details Options are named by their long form if they have one, as in
+     *          the usage message.
+     */
+    COMMANDLINE_INLINE
+    void interface::violate(errors_t* errors, errcode_t code, optid_t id,
+                            optid_t other, std::string_view value) const
+    {
+        if (errors)
+        {
+            errors->add(code, 0, id);
+            return;
+        }
+
+        auto name = [this](optid_t i)
+            {
+                const option_info_t& data = this->m_options[i];
+                return data.longopt.empty() ? data.shortopt : data.longopt;
+            };
+
+        std::string_view option = name(id);
+        int              size   = static_cast<int>(option.size());
+        switch (code)
+        {
+        case commandline::conflicting_options:
+            fprintf(stderr, "%s: Options '%.*s' and '%.*s' cannot be used together.\n",
+                    program_name(), size, option.data(),
+                    static_cast<int>(name(other).size()), name(other).data());
+            break;
+        case commandline::missing_requirement:
+            fprintf(stderr, "%s: Option '%.*s' requires option '%.*s'.\n",
+                    program_name(), size, option.data(),
+                    static_cast<int>(name(other).size()), name(other).data());
+            break;
+        case commandline::invalid_choice:
+            fprintf(stderr, "%s: Invalid value '%.*s' for option '%.*s'; choices:",
+                    program_name(), static_cast<int>(value.size()),
+                    value.data(), size, option.data());
+            {
+                const rules_t& rules = this->m_options.rules(id);
+                for (size_t i=0; i < rules.choices; ++i)
+                {
+                    std::string_view choice =
+                        this->m_options.choice(rules.first_choice+i);
+                    fprintf(stderr, " '%.*s'",
+                            static_cast<int>(choice.size()), choice.data());
+                }
+            }
+            fprintf(stderr, "\n");
+            break;
+        case commandline::out_of_range:
+            fprintf(stderr, "%s: Value '%.*s' for option '%.*s' is out of range.\n",
+                    program_name(), static_cast<int>(value.size()),
+                    value.data(), size, option.data());
+            break;
+        default:
+            fprintf(stderr, "%s: Wrong number of values for option '%.*s'.\n",
+                    program_name(), size, option.data());
+            break;
+        }
+        exit(1);
+    }
+
+    /**
+     * @details The key of the cache file mixes the hash of the arguments with
+     *          the fingerprint, and the arguments are stored in the file as
+     *          well, so that a hash collision is never mistaken for a hit.
+     */
+    COMMANDLINE_INLINE
+    bool interface::parse_cached(char** argv, const char* directory)
+    {
+        std::string args;
+        bool        cacheable = (*argv != NULL);
+        bool        files     = (this->m_limits.response_files > 0);
+
+        for (char** argp=argv+1; cacheable && (*argp != NULL); ++argp)
+        {
+            cacheable = !files || ((*argp)[0] != '@');
+            args.append(*argp).push_back('\0');
+        }
+
+        if (!cacheable)
+        {
+            this->parse(argv);
+            return false;
+        }
+
+        uint64_t print = this->fingerprint();
+        uint64_t key   = (static_cast<uint64_t>(fnv1a(args,
+                              static_cast<uint32_t>(print >> 32))) << 32)
+                         | fnv1a(args, static_cast<uint32_t>(print));
+        char     name[32];
+        snprintf(name, sizeof(name), "/%016llx.cache",
+                 static_cast<unsigned long long>(key));
+
+        std::string path(directory);
+        path.append(name);
+        if (this->load_cache(path, args))
+        {
+            this->check(NULL);
+            return true;
+        }
+
+        this->parse(argv);
+        this->store_cache(path, args);
+        return false;
+    }
+
+    /**
+     * @details Two differently seeded hashes are chained over the option
+     *          strings and types, so that the options and their order both
+     *          count. The constraints of the options count as well, if they
+     *          have any, so that results made under other constraints are
+     *          never loaded.
+     */
+    COMMANDLINE_INLINE
+    uint64_t interface::fingerprint(void) const
+    {
+        uint32_t low  = 0;
+        uint32_t high = 0x9e3779b9u;
+
+        for (const option_info_t& data : this->m_options)
+        {
+            const char types[2] = {static_cast<char>(data.argument),
+                                   static_cast<char>(data.type)};
+            for (std::string_view field : {std::string_view(data.shortopt),
+                                           std::string_view(data.longopt),
+                                           std::string_view(types, 2)})
+            {
+                low  = fnv1a(field, low);
+                high = fnv1a(field, high);
+            }
+        }
+
+        if (this->m_options.constrained())
+        {
+            size_t n     = this->m_options.size();
+            size_t words = this->m_options.words();
+            for (size_t i=0; i < n; ++i)
+            {
+                const rules_t& rules = this->m_options.rules(i);
+                std::string    fields(reinterpret_cast<const char*>(&rules),
+                                      sizeof(rules));
+                fields.append(reinterpret_cast<const char*>(
+                                  this->m_options.conflicts(i)),
+                              words*sizeof(uint64_t));
+                fields.append(reinterpret_cast<const char*>(
+                                  this->m_options.depends(i)),
+                              words*sizeof(uint64_t));
+                for (size_t j=0; j < rules.choices; ++j)
+                {
+                    fields.append(this->m_options.choice(rules.first_choice+j))
+                        .push_back('\0');
+                }
+                low  = fnv1a(fields, low);
+                high = fnv1a(fields, high);
+            }
+        }
+        return (static_cast<uint64_t>(high) << 32) | low;
+    }
+
+    /**
+     * @details Used as a test to make sure that command line options were
+     *          interpretted correctly. If there is ever any doubt, this
+     *          function can be used.
+     */
+    COMMANDLINE_INLINE
+    void interface::test(void)
+    {
+        int i;
+        for (optid_t id=0; id < this->m_results.size(); ++id)
+        {
+            const auto& values = this->m_results[id].values;
+            if (values.empty())
+            {
+                continue;
+            }
+
+            std::string_view key = this->to_key(&this->m_options[id]);
+            printf("%.*s: ", static_cast<int>(key.size()), key.data());
+
+            i = 0;
+            for (const auto& a : values)
+            {
+                if (i > 0)
+                {
+                    printf(", ");
+                }
+                printf("%s", a.c_str());
+                ++i;
+            }
+            printf("\n");
+        }
+    }
+
+    /**
+     * @details The value is converted before it is stored, so that a value
+     *          that cannot be converted is not stored at all. Only the first
+     *          value of an option is kept in converted form.
+     */
+    COMMANDLINE_INLINE
+    int interface::set(std::string_view option, std::string_view value,
+                       layer_t layer)
+    {
+        optid_t id = this->id(option);
+        if ((id == kNoOption) || this->to_key(&this->m_options[id]).empty())
+        {
+            return -1;
+        }
+        return this->store(id, value, layer);
+    }
+
+    /**
+     * @details Each value is stored straight from the line buffer of
+     *          read_lines().
+     */
+    COMMANDLINE_INLINE
+    int interface::load_config(const char* path)
+    {
+        int  ret  = 0;
+        bool read = read_lines(path, [this, &ret](std::string_view text)
+            {
+                size_t           equals = text.find('=');
+                std::string_view key    = text.substr(0, equals);
+                std::string_view value;
+                if (equals != std::string_view::npos)
+                {
+                    value = text.substr(equals+1);
+                    value.remove_prefix(
+                        std::min(value.find_first_not_of(kSpace),
+                                 value.size()));
+                }
+                key = key.substr(0, key.find_last_not_of(kSpace)+1);
+
+                if (this->set(key, value, config_layer) != 0)
+                {
+                    ret = -2;
+                }
+            });
+        return read ? ret : -1;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    int interface::load_environment(std::string_view prefix)
+    {
+        std::string name(prefix);
+        int         ret = 0;
+
+        for (optid_t id=0; id < this->m_options.size(); ++id)
+        {
+            std::string_view key = this->to_key(&this->m_options[id]);
+            if (key.empty())
+            {
+                continue;
+            }
+
+            name.resize(prefix.size());
+            for (char c : key)
+            {
+                name.push_back((c == '-') ? '_' : static_cast<char>(
+                    toupper(static_cast<unsigned char>(c))));
+            }
+
+            const char* value = getenv(name.c_str());
+            if (value && (this->store(id, value, environment_layer) != 0))
+            {
+                ret = -2;
+            }
+        }
+        return ret;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void interface::set_limits(const limits_t& bounds)
+    {
+        this->m_limits = bounds;
+    }
+
+    /**
+     * @details Values from a later layer replace those of an earlier one, and
+     *          values from the same layer are added to them.
+     */
+    COMMANDLINE_INLINE
+    int interface::store(optid_t id, std::string_view value, layer_t layer)
+    {
+        const option_info_t* data  = &this->m_options[id];
+        result_t&       entry = this->m_results[id];
+        typedval_t      converted;
+
+        if (!entry.values.empty() && (layer < entry.layer))
+        {
+            return 0;
+        }
+
+        if ((data->type != string_value) && !value.empty()
+            && !this->convert(data->type, value, converted))
+        {
+            return -2;
+        }
+
+        if (layer > entry.layer)
+        {
+            entry.values.clear();
+        }
+
+        if (entry.values.empty())
+        {
+            entry.value = converted;
+        }
+        COMMANDLINE_COUNT(this->m_stats.allocations,
+                          (entry.values.size() == entry.values.capacity())
+                          + (value.size() > std::pmr::string().capacity()));
+        COMMANDLINE_COUNT(this->m_stats.bytes, value.size());
+        entry.layer = layer;
+        entry.values.emplace_back(value);
+        this->m_present[id/64] |= uint64_t(1) << (id%64);
+        return 0;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    std::string interface::get(std::string_view option) const
+    {
+        return std::string(this->get(this->id(option)));
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    std::string_view interface::get(optid_t id) const
+    {
+        return this->has(id) ?
+            std::string_view(this->m_results[id].values.front()) : "";
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool interface::has(std::string_view option) const
+    {
+        return this->has(this->id(option));
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool interface::has(optid_t id) const
+    {
+        return ((id < this->m_results.size())
+                && ((this->m_present[id/64] >> (id%64)) & 1));
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    optid_t interface::id(std::string_view option) const
+    {
+        return this->to_id(this->to_option(option));
+    }
+
+    /**
+     * @details Index both the short and long form of every option. Options
+     *          listed first take precedence when two of them share a string,
+     *          the same as a linear search would. Long option keys are indexed
+     *          before any short option key, as to_key() tries the long form of
+     *          a dashless string first.
+     */
+    COMMANDLINE_INLINE
+    void interface::index(void)
+    {
+        auto   index = std::make_shared<strindex_t>();
+        auto   keys  = std::make_shared<strindex_t>();
+        size_t size  = this->m_options.size();
+        size_t i;
+
+        index->reserve(2*size);
+        keys->reserve(2*size);
+
+        for (i=0; i < size; ++i)
+        {
+            std::string_view shortopt = this->m_options[i].shortopt;
+            std::string_view longopt  = this->m_options[i].longopt;
+
+            if (!shortopt.empty())
+            {
+                index->emplace(shortopt, i);
+                this->m_dashed = this->m_dashed && (shortopt[0] == '-');
+            }
+            if (!longopt.empty())
+            {
+                index->emplace(longopt, i);
+                this->m_dashed = this->m_dashed && (longopt[0] == '-');
+            }
+            if (longopt.substr(0, 2) == "--")
+            {
+                keys->emplace(longopt.substr(2), i);
+            }
+        }
+
+        for (i=0; i < size; ++i)
+        {
+            std::string_view shortopt = this->m_options[i].shortopt;
+            if (shortopt.substr(0, 1) == "-")
+            {
+                keys->emplace(shortopt.substr(1), i);
+            }
+        }
+
+        auto prefixes = std::make_shared<prefixes_t>();
+        prefixes->reserve(size);
+        for (i=0; i < size; ++i)
+        {
+            std::string_view longopt = this->m_options[i].longopt;
+            if (longopt.substr(0, 2) == "--")
+            {
+                prefixes->emplace_back(longopt, i);
+            }
+        }
+
+        std::stable_sort(prefixes->begin(), prefixes->end(),
+            [](const prefix_t& a, const prefix_t& b)
+            {
+                return a.first < b.first;
+            });
+        prefixes->erase(std::unique(prefixes->begin(), prefixes->end(),
+            [](const prefix_t& a, const prefix_t& b)
+            {
+                return a.first == b.first;
+            }), prefixes->end());
+
+        auto shorts = std::make_shared<shortindex_t>();
+        shorts->fill(kNoOption);
+        for (i=0; i < size; ++i)
+        {
+            std::string_view shortopt = this->m_options[i].shortopt;
+            if ((shortopt.size() == 2) && (shortopt[0] == '-'))
+            {
+                size_t& entry =
+                    (*shorts)[static_cast<unsigned char>(shortopt[1])];
+                entry = (entry == kNoOption) ? i : entry;
+            }
+        }
+
+        this->m_index    = std::move(index);
+        this->m_keys     = std::move(keys);
+        this->m_prefixes = std::move(prefixes);
+        this->m_shorts   = std::move(shorts);
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void interface::parse_help_option(const option_info_t* data)
+    {
+        if ((data->longopt == "--help") || (data->shortopt == "-?"))
+        {
+            this->usage();
+            exit(0);
+        }
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void interface::parse_event(const event_t& event, errors_t* errors)
+    {
+        const option_info_t* data = &this->m_options[event.id];
+        if (!errors && (data->argument == commandline::no_argument))
+        {
+            this->parse_help_option(data);
+        }
+
+        const result_t& entry = this->m_results[event.id];
+        if ((entry.layer == command_layer)
+            && (entry.values.size() >= this->m_limits.values))
+        {
+            if (errors)
+            {
+                errors->add(input_too_large, event.index, event.id);
+                return;
+            }
+
+            fprintf(stderr, "%s: Too many values for option '%.*s'.\n",
+                    program_name(), static_cast<int>(event.option.size()),
+                    event.option.data());
+            exit(1);
+        }
+
+        if (this->store(event.id, event.value) != -2)
+        {
+            return;
+        }
+
+        if (errors)
+        {
+            errors->add(invalid_value, event.index, event.id);
+            return;
+        }
+
+        fprintf(stderr, "%s: Invalid value '%.*s' for option '%.*s'.\n",
+                program_name(), static_cast<int>(event.value.size()),
+                event.value.data(), static_cast<int>(event.option.size()),
+                event.option.data());
+        exit(1);
+    }
+
+    /**
+     * @details An exact match on either form is tried first. Failing that, a
+     *          string of the form '--long-option=value' is resolved through its
+     *          option section, which is only allowed to match a long option.
+     */
+    COMMANDLINE_INLINE
+    const option_info_t* interface::find_option(std::string_view option) const
+    {
+        return this->find_option(classify(option));
+    }
+
+    /**
+     * @details A token without a leading dash is rejected without a lookup,
+     *          when every option starts with a dash.
+     */
+    COMMANDLINE_INLINE
+    const option_info_t* interface::find_option(const token_t& token) const
+    {
+        if (this->m_dashed && (token.dashes == 0))
+        {
+            return NULL;
+        }
+
+        size_t i = this->find_index(token.text);
+        if (i != kNoOption)
+        {
+            return &this->m_options[i];
+        }
+
+        if (token.equals != std::string_view::npos)
+        {
+            i = this->find_index(token.option());
+            if ((i != kNoOption)
+                && (token.option() == this->m_options[i].longopt))
+            {
+                return &this->m_options[i];
+            }
+        }
+
+        return this->find_abbreviation(token.option());
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    const option_info_t* interface::find_abbreviation(std::string_view option) const
+    {
+        if ((option.size() <= 2) || (option.substr(0, 2) != "--"))
+        {
+            return NULL;
+        }
+
+        prefix_range_t range = this->find_prefix(option);
+        return ((range.second - range.first) == 1) ?
+            &this->m_options[range.first->second] : NULL;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    size_t interface::find_short(char c) const
+    {
+        COMMANDLINE_PROBE();
+        if (this->m_lookup)
+        {
+            return this->m_lookup->find_short(c);
+        }
+        return (*this->m_shorts)[static_cast<unsigned char>(c)];
+    }
+
+    /**
+     * @details Only a token with a single leading dash, and at least two
+     *          characters after it, can be a cluster.
+     */
+    COMMANDLINE_INLINE
+    const option_info_t* interface::find_cluster(const token_t& token) const
+    {
+        if ((token.dashes != 1) || (token.text.size() < 3))
+        {
+            return NULL;
+        }
+
+        size_t i = this->find_short(token.text[1]);
+        return (i != kNoOption) ? &this->m_options[i] : NULL;
+    }
+
+    /**
+     * @details Both ends of the range are found with a binary search, where
+     *          each comparison is bounded by the length of the prefix.
+     */
+    COMMANDLINE_INLINE
+    interface::prefix_range_t
+    interface::find_prefix(std::string_view prefix) const
+    {
+        COMMANDLINE_PROBE();
+        if (!this->m_prefixes)
+        {
+            return prefix_range_t(NULL, NULL);
+        }
+
+        const prefix_t* begin = this->m_prefixes->data();
+        const prefix_t* end   = begin + this->m_prefixes->size();
+
+        const prefix_t* first = std::lower_bound(begin, end, prefix,
+            [](const prefix_t& entry, std::string_view key)
+            {
+                return entry.first < key;
+            });
+        const prefix_t* last = std::upper_bound(first, end, prefix,
+            [](std::string_view key, const prefix_t& entry)
+            {
+                return key < entry.first.substr(0, key.size());
+            });
+        return prefix_range_t(first, last);
+    }
+
+    /**
+     * @details Destroying the strings returns their memory to the resource,
+     *          which a monotonic resource only reclaims when it is released.
+     */
+    COMMANDLINE_INLINE
+    void interface::reset(void)
+    {
+        for (result_t& entry : this->m_results)
+        {
+            entry.values.clear();
+            entry.value = std::monostate();
+            entry.layer = default_layer;
+        }
+        std::fill(this->m_present.begin(), this->m_present.end(), 0);
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    std::shared_ptr<const interface> interface::freeze(void) const
+    {
+        return std::make_shared<const interface>(*this);
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    optid_t interface::to_id(const option_info_t* data) const
+    {
+        return (data) ? static_cast<optid_t>(data - this->m_options.data())
+            : kNoOption;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    const typedval_t* interface::find_value(optid_t id) const
+    {
+        return this->has(id) ? &this->m_results[id].value : NULL;
+    }
+
+    /**
+     * @details Numbers are converted with std::from_chars, which neither
+     *          allocates nor depends on the locale. A duration is an integer
+     *          count followed by its unit.
+     */
+    COMMANDLINE_INLINE
+    bool interface::convert(value_t type, std::string_view input,
+                            typedval_t& output) const
+    {
+        const char* first = input.data();
+        const char* last  = input.data() + input.size();
+        long long   integer;
+        double      floating;
+
+        switch (type)
+        {
+        case commandline::integer_value:
+        {
+            std::from_chars_result result = std::from_chars(first, last,
+                                                            integer);
+            if ((result.ec != std::errc()) || (result.ptr != last))
+            {
+                return false;
+            }
+            output = integer;
+            return true;
+        }
+        case commandline::floating_value:
+        {
+            std::from_chars_result result = std::from_chars(first, last,
+                                                            floating);
+            if ((result.ec != std::errc()) || (result.ptr != last))
+            {
+                return false;
+            }
+            output = floating;
+            return true;
+        }
+        case commandline::duration_value:
+        {
+            std::from_chars_result result = std::from_chars(first, last,
+                                                            integer);
+            if (result.ec != std::errc())
+            {
+                return false;
+            }
+
+            std::string_view unit(result.ptr, last-result.ptr);
+            long long        scale;
+            if (unit == "ns")
+            {
+                scale = 1;
+            }
+            else if (unit == "us")
+            {
+                scale = std::nano::den / std::micro::den;
+            }
+            else if (unit == "ms")
+            {
+                scale = std::nano::den / std::milli::den;
+            }
+            else if (unit == "s")
+            {
+                scale = std::nano::den;
+            }
+            else if (unit == "m")
+            {
+                scale = std::nano::den * 60;
+            }
+            else if (unit == "h")
+            {
+                scale = std::nano::den * 3600;
+            }
+            else
+            {
+                return false;
+            }
+
+            /* Untrusted input must not overflow the nanoseconds count. */
+            typedef std::chrono::nanoseconds::rep rep_t;
+            if ((integer > std::numeric_limits<rep_t>::max() / scale)
+                || (integer < std::numeric_limits<rep_t>::min() / scale))
+            {
+                return false;
+            }
+            output = std::chrono::nanoseconds(integer * scale);
+            return true;
+        }
+        case commandline::string_value:
+        default:
+            return false;
+        }
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    size_t interface::find_index(std::string_view option) const
+    {
+        COMMANDLINE_PROBE();
+        if (this->m_lookup)
+        {
+            return this->m_lookup->find(option);
+        }
+
+        auto it = this->m_index->find(option);
+        return (it != this->m_index->end()) ? it->second : kNoOption;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    size_t interface::find_key(std::string_view key) const
+    {
+        COMMANDLINE_PROBE();
+        if (this->m_lookup)
+        {
+            return this->m_lookup->find_key(key);
+        }
+
+        auto it = this->m_keys->find(key);
+        return (it != this->m_keys->end()) ? it->second : kNoOption;
+    }
+
+    /**
+     * @details Check if the input string has any dashes in front. If not, look
+     *          it up in the key index, where long option keys take precedence
+     *          over short option keys. Otherwise, find the corresponding option
+     *          struct.
+     */
+    COMMANDLINE_INLINE
+    const option_info_t* interface::to_option(std::string_view input) const
+    {
+        if (input.empty())
+        {
+            return NULL;
+        }
+
+        if (input[0] != '-')
+        {
+            size_t i = this->find_key(input);
+            return (i != kNoOption) ? &this->m_options[i] : NULL;
+        }
+        return this->find_option(input);
+    }
+
+    /**
+     * @details By default, the long option is used as the key, without the
+     *          leading dashes. However, if there is no long option, the short
+     *          option is used, also without the leading dash.
+     */
+    COMMANDLINE_INLINE
+    std::string_view interface::to_key(const option_info_t* data) const
+    {
+        if (!data)
+        {
+            return "";
+        }
+
+        std::string_view longopt  = data->longopt;
+        std::string_view shortopt = data->shortopt;
+        if (!longopt.empty())
+        {
+            return longopt.substr(2);
+        }
+        else if (!shortopt.empty())
+        {
+            return shortopt.substr(1);
+        }
+        else
+        {
+            return "";
+        }
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool interface::is_short_option(const option_info_t* data,
+                                    std::string_view option) const
+    {
+        return (data && (option == data->shortopt));
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool interface::is_long_option(const option_info_t* data,
+                                   const token_t& token) const
+    {
+        if (!data)
+        {
+            return false;
+        }
+
+        std::string_view option = token.option();
+        return ((option == data->longopt)
+                || ((option.size() > 2) && (option.substr(0, 2) == "--")
+                    && (data->longopt.substr(0, option.size()) == option)));
+    }
+
+    /**
+     * @brief Identifies a cache file.
+     */
+    const uint32_t kCacheMagic = 0x31434c43;
+
+    /**
+     * @details The image is laid out as the header, every entry, every value,
+     *          and then the string pool, where each string is followed by a
+     *          NUL character. Integers are in the byte order of the host.
+     */
+    COMMANDLINE_INLINE
+    void interface::serialize(std::string& out, layer_t layer) const
+    {
+        image_header header = {kImageMagic,
+                               static_cast<uint32_t>(this->m_options.size()),
+                               this->fingerprint(), 0, 0, 0, 0};
+
+        for (const result_t& entry : this->m_results)
+        {
+            if (entry.values.empty() || (entry.layer < layer))
+            {
+                continue;
+            }
+
+            ++header.entries;
+            header.values += static_cast<uint32_t>(entry.values.size());
+            for (const auto& value : entry.values)
+            {
+                header.pool += static_cast<uint32_t>(value.size() + 1);
+            }
+        }
+
+        size_t base   = out.size();
+        size_t values = base + sizeof(header)
+            + header.entries*sizeof(image_entry);
+        size_t pool   = values + header.values*sizeof(image_value);
+        out.resize(pool + header.pool);
+        memcpy(&out[base], &header, sizeof(header));
+
+        size_t   next  = base + sizeof(header);
+        uint32_t first = 0;
+        uint32_t used  = 0;
+        for (optid_t id=0; id < this->m_results.size(); ++id)
+        {
+            const result_t& result = this->m_results[id];
+            if (result.values.empty() || (result.layer < layer))
+            {
+                continue;
+            }
+
+            image_entry entry = {static_cast<uint32_t>(id),
+                                 static_cast<uint32_t>(result.layer), first,
+                                 static_cast<uint32_t>(result.values.size()),
+                                 static_cast<uint32_t>(result.value.index()),
+                                 0, 0};
+            if (auto p = std::get_if<long long>(&result.value))
+            {
+                memcpy(&entry.payload, p, sizeof(*p));
+            }
+            else if (auto p = std::get_if<double>(&result.value))
+            {
+                memcpy(&entry.payload, p, sizeof(*p));
+            }
+            else if (auto p = std::get_if<std::chrono::nanoseconds>(
+                         &result.value))
+            {
+                int64_t count = p->count();
+                memcpy(&entry.payload, &count, sizeof(count));
+            }
+            memcpy(&out[next], &entry, sizeof(entry));
+            next += sizeof(entry);
+
+            for (const auto& string : result.values)
+            {
+                image_value value = {used,
+                                     static_cast<uint32_t>(string.size())};
+                memcpy(&out[values + first*sizeof(value)], &value,
+                       sizeof(value));
+                memcpy(&out[pool + used], string.data(), string.size());
+                out[pool + used + string.size()] = '\0';
+                used += value.size + 1;
+                ++first;
+            }
+        }
+    }
+
+    /**
+     * @details Every count, offset and size is checked against the size of the
+     *          image, before anything is read through them.
+     */
+    COMMANDLINE_INLINE
+    bool validate_image(std::string_view image, uint64_t fingerprint,
+                        size_t options)
+    {
+        const char*  data   = image.data();
+        image_header header;
+
+        if ((image.size() < sizeof(header))
+            || (reinterpret_cast<uintptr_t>(data) % alignof(image_entry)))
+        {
+            return false;
+        }
+        memcpy(&header, data, sizeof(header));
+
+        uint64_t values = sizeof(header)
+            + static_cast<uint64_t>(header.entries)*sizeof(image_entry);
+        uint64_t pool   = values
+            + static_cast<uint64_t>(header.values)*sizeof(image_value);
+        if ((header.magic != kImageMagic) || (header.options != options)
+            || (header.fingerprint != fingerprint)
+            || (pool + header.pool != image.size()))
+        {
+            return false;
+        }
+
+        auto entries = reinterpret_cast<const image_entry*>(
+            data + sizeof(header));
+        auto strings = reinterpret_cast<const image_value*>(data + values);
+        for (uint32_t i=0; i < header.entries; ++i)
+        {
+            const image_entry& entry = entries[i];
+            if ((entry.id >= header.options)
+                || ((i > 0) && (entry.id <= entries[i-1].id))
+                || (entry.layer > command_layer)
+                || (entry.type >= std::variant_size_v<typedval_t>)
+                || (static_cast<uint64_t>(entry.first) + entry.count
+                    > header.values))
+            {
+                return false;
+            }
+        }
+
+        for (uint32_t i=0; i < header.values; ++i)
+        {
+            if (static_cast<uint64_t>(strings[i].offset) + strings[i].size
+                >= header.pool)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    typedval_t decode_value(const image_entry& entry)
+    {
+        long long integer;
+        double    floating;
+
+        switch (entry.type)
+        {
+        case 1:
+            memcpy(&integer, &entry.payload, sizeof(integer));
+            return integer;
+        case 2:
+            memcpy(&floating, &entry.payload, sizeof(floating));
+            return floating;
+        case 3:
+            memcpy(&integer, &entry.payload, sizeof(integer));
+            return std::chrono::nanoseconds(integer);
+        default:
+            return std::monostate();
+        }
+    }
+
+    /**
+     * @details The whole image is validated before the first value is stored.
+     */
+    COMMANDLINE_INLINE
+    bool interface::deserialize(std::string_view image)
+    {
+        if (!validate_image(image, this->fingerprint(), this->m_options.size()))
+        {
+            return false;
+        }
+
+        results_view view(*this, image);
+        for (uint32_t i=0; i < view.m_header->entries; ++i)
+        {
+            const image_entry& entry  = view.m_entries[i];
+            layer_t            layer  = static_cast<layer_t>(entry.layer);
+            result_t&          result = this->m_results[entry.id];
+            if (!result.values.empty() && (layer < result.layer))
+            {
+                continue;
+            }
+
+            result.values.clear();
+            for (uint32_t j=0; j < entry.count; ++j)
+            {
+                result.values.emplace_back(view.string(entry.first+j));
+            }
+            result.value = decode_value(entry);
+            result.layer = layer;
+            if (result.values.empty())
+            {
+                this->m_present[entry.id/64] &= ~(uint64_t(1) << (entry.id%64));
+            }
+            else
+            {
+                this->m_present[entry.id/64] |= uint64_t(1) << (entry.id%64);
+            }
+        }
+        return true;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    results_view::results_view(const interface& cli, std::string_view image)
+        : m_cli(cli),
+          m_header(NULL),
+          m_entries(NULL),
+          m_values(NULL),
+          m_pool(NULL)
+    {
+        if (!validate_image(image, cli.fingerprint(), cli.m_options.size()))
+        {
+            return;
+        }
+
+        const char* data = image.data();
+        m_header  = reinterpret_cast<const image_header*>(data);
+        m_entries = reinterpret_cast<const image_entry*>(
+            data + sizeof(image_header));
+        m_values  = reinterpret_cast<const image_value*>(
+            m_entries + m_header->entries);
+        m_pool    = reinterpret_cast<const char*>(
+            m_values + m_header->values);
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool results_view::valid(void) const
+    {
+        return (this->m_header != NULL);
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool results_view::has(std::string_view option) const
+    {
+        return this->has(this->m_cli.id(option));
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool results_view::has(optid_t id) const
+    {
+        return (this->find_entry(id) != NULL);
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    std::string_view results_view::get(std::string_view option) const
+    {
+        return this->get(this->m_cli.id(option));
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    std::string_view results_view::get(optid_t id) const
+    {
+        return this->get(id, 0);
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    std::string_view results_view::get(optid_t id, size_t i) const
+    {
+        const image_entry* entry = this->find_entry(id);
+        return (entry && (i < entry->count)) ?
+            this->string(entry->first+i) : "";
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    size_t results_view::count(optid_t id) const
+    {
+        const image_entry* entry = this->find_entry(id);
+        return entry ? entry->count : 0;
+    }
+
+    /**
+     * @details Entries are sorted by option ID, so they are binary searched.
+     */
+    COMMANDLINE_INLINE
+    const image_entry* results_view::find_entry(optid_t id) const
+    {
+        if (!this->m_header)
+        {
+            return NULL;
+        }
+
+        const image_entry* end   = this->m_entries + this->m_header->entries;
+        const image_entry* entry = std::lower_bound(this->m_entries, end, id,
+            [](const image_entry& item, optid_t key)
+            {
+                return item.id < key;
+            });
+        return ((entry != end) && (entry->id == id)) ? entry : NULL;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    std::string_view results_view::string(size_t i) const
+    {
+        const image_value& value = this->m_values[i];
+        return std::string_view(this->m_pool + value.offset, value.size);
+    }
+
+    /**
+     * @details The file holds a header with the size of the arguments, the
+     *          arguments, padding to 8 bytes, and the image of the results.
+     */
+    COMMANDLINE_INLINE
+    bool interface::load_cache(const std::string& path, std::string_view args)
+    {
+        struct stat info;
+        int         fd;
+
+        if ((fd=open(path.c_str(), O_RDONLY)) < 0)
+        {
+            return false;
+        }
+
+        if ((fstat(fd, &info) < 0) || (info.st_size <= 0))
+        {
+            close(fd);
+            return false;
+        }
+
+        size_t size = static_cast<size_t>(info.st_size);
+        void*  map  = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+        {
+            return false;
+        }
+
+        const char* data   = static_cast<const char*>(map);
+        uint32_t    header[2];
+        size_t      offset = sizeof(header) + ((args.size()+7) & ~size_t(7));
+        bool        hit    = false;
+
+        if (size >= offset)
+        {
+            memcpy(header, data, sizeof(header));
+            hit = (header[0] == kCacheMagic) && (header[1] == args.size())
+                && (std::string_view(data + sizeof(header), args.size())
+                    == args)
+                && this->deserialize(std::string_view(data + offset,
+                                                      size - offset));
+        }
+
+        munmap(map, size);
+        return hit;
+    }
+
+    /**
+     * @details The file is written under a temporary name, and renamed over
+     *          the cache file, so that a reader never sees it half written.
+     */
+    COMMANDLINE_INLINE
+    void interface::store_cache(const std::string& path,
+                                std::string_view args) const
+    {
+        uint32_t    header[2] = {kCacheMagic,
+                                 static_cast<uint32_t>(args.size())};
+        std::string buffer(reinterpret_cast<const char*>(header),
+                           sizeof(header));
+
+        buffer.append(args);
+        buffer.resize(sizeof(header) + ((args.size()+7) & ~size_t(7)), '\0');
+        this->serialize(buffer, command_layer);
+
+        std::string temp(path);
+        temp.append(".").append(std::to_string(getpid()));
+
+        int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        bool written = write_all(fd, buffer);
+        if ((close(fd) < 0) || !written
+            || (rename(temp.c_str(), path.c_str()) < 0))
+        {
+            unlink(temp.c_str());
+        }
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool interface::write_all(int fd, std::string_view data)
+    {
+        const char* next = data.data();
+        size_t      size = data.size();
+        ssize_t     n;
+
+        while (size > 0)
+        {
+            if ((n=write(fd, next, size)) < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            next += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @details The '=' is found with std::string_view::find(), which is a
+     *          memchr() that the C library vectorises.
+     */
+    COMMANDLINE_INLINE
+    token_t classify(std::string_view text)
+    {
+        token_t token;
+        token.text   = text;
+        token.dashes = text.find_first_not_of('-');
+        token.equals = text.find('=');
+        if (token.dashes == std::string_view::npos)
+        {
+            token.dashes = text.size();
+        }
+        return token;
+    }
+
+    /**
+     * @details Chunks of kBatchChunk jobs amortise the shared counter, while
+     *          staying small enough to balance jobs of uneven length.
+     */
+    COMMANDLINE_INLINE
+    std::vector<snapshot_t> parse_batch(const interface& cli,
+                                        const std::vector<char**>& jobs,
+                                        std::vector<errors_t>& errors,
+                                        unsigned threads)
+    {
+        const size_t kBatchChunk = 64;
+
+        std::vector<snapshot_t> results(jobs.size());
+        std::atomic<size_t>     next(0);
+        size_t                  chunks = (jobs.size()+kBatchChunk-1)
+                                         / kBatchChunk;
+
+        errors.assign(jobs.size(), errors_t());
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = static_cast<unsigned>(
+            std::min(static_cast<size_t>(threads), std::max<size_t>(chunks, 1)));
+
+        auto work = [&]()
+            {
+                size_t begin;
+                while ((begin=kBatchChunk*next.fetch_add(1)) < jobs.size())
+                {
+                    size_t end = std::min(begin+kBatchChunk, jobs.size());
+                    for (size_t i=begin; i < end; ++i)
+                    {
+                        auto result = std::make_shared<interface>(cli);
+                        result->parse(jobs[i], errors[i]);
+                        results[i] = std::move(result);
+                    }
+                }
+            };
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads-1);
+        for (unsigned i=1; i < threads; ++i)
+        {
+            workers.emplace_back(work);
+        }
+
+        work();
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+        return results;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void subcommands::add(std::string_view name, factory_t factory,
+                          std::string_view desc)
+    {
+        entry command;
+        command.name    = name;
+        command.desc    = desc;
+        command.factory = std::move(factory);
+        this->m_commands.push_back(std::move(command));
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void subcommands::usage(void) const
+    {
+        printf("Usage: %s <command> [option]...\n\n", program_name());
+        printf("Commands:");
+        for (const entry& command : this->m_commands)
+        {
+            printf("\n    %s\n        %s\n", command.name.c_str(),
+                   command.desc.c_str());
+        }
+    }
+
+    /**
+     * @details argv+1 is parsed, so that the subcommand name takes the place
+     *          of the program name, which parse() skips.
+     */
+    COMMANDLINE_INLINE
+    interface& subcommands::parse(char** argv)
+    {
+        if (!argv[0] || !argv[1])
+        {
+            fprintf(stderr, "%s: No command entered.\n", program_name());
+            exit(1);
+        }
+
+        std::string_view name(argv[1]);
+        if ((name == "--help") || (name == "-h") || (name == "-?"))
+        {
+            this->usage();
+            exit(0);
+        }
+
+        size_t i;
+        for (i=0; i < this->m_commands.size(); ++i)
+        {
+            if (this->m_commands[i].name == name)
+            {
+                break;
+            }
+        }
+
+        if (i == this->m_commands.size())
+        {
+            fprintf(stderr, "%s: Unknown command '%s'.\n", program_name(),
+                    argv[1]);
+            exit(1);
+        }
+
+        this->m_current   = i;
+        this->m_interface = std::make_unique<interface>(
+            this->m_commands[i].factory());
+        this->m_interface->parse(argv+1);
+        return *this->m_interface;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    std::string_view subcommands::command(void) const
+    {
+        return (this->m_current < this->m_commands.size()) ?
+            std::string_view(this->m_commands[this->m_current].name) : "";
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    stream::stream(const interface& cli, callback_t callback,
+                   errors_t* errors)
+        : m_cli(cli),
+          m_callback(std::move(callback)),
+          m_errors(errors),
+          m_count(0),
+          m_tokens(0),
+          m_current(0),
+          m_pending(NULL),
+          m_pendingindex(0),
+          m_list(NULL),
+          m_listindex(0),
+          m_listempty(false),
+          m_depth(0),
+          m_open(),
+          m_files(0)
+    {
+    }
+
+    /**
+     * @details Check if the previous option is waiting for an argument, or has
+     *          a list_argument type, and if it does, store the token as its
+     *          argument. Otherwise, the token must be an option, and which
+     *          takes 0 or 1 argument is determined by its argument type.
+     */
+    COMMANDLINE_INLINE
+    void stream::feed(std::string_view token)
+    {
+        token_t classified;
+        {
+            COMMANDLINE_TIME(this->m_stats.tokenise);
+            classified = classify(token);
+        }
+        this->feed(classified);
+    }
+
+    /**
+     * @details The tokens of a response file are fed while it is being read,
+     *          and keep the position of its '@file' argument, so that every
+     *          position is one of the arguments fed.
+     */
+    COMMANDLINE_INLINE
+    void stream::feed(const token_t& token)
+    {
+        COMMANDLINE_PROBES(this->m_stats);
+        if (this->m_depth == 0)
+        {
+            this->m_current = this->m_count++;
+        }
+        ++this->m_tokens;
+        COMMANDLINE_COUNT(this->m_stats.tokens, 1);
+        if ((this->m_tokens > this->m_cli.m_limits.tokens)
+            || (token.text.size() > this->m_cli.m_limits.token_size))
+        {
+            this->fail(input_too_large, this->m_current, token.text);
+            return;
+        }
+        if ((token.text.size() > 1) && (token.text[0] == '@')
+            && (this->m_cli.m_limits.response_files > 0))
+        {
+            this->parse_response_file(token.text);
+            return;
+        }
+
+        const option_info_t* data;
+        bool            cluster = false;
+        {
+            COMMANDLINE_TIME(this->m_stats.resolve);
+            data = this->m_cli.find_option(token);
+            if (!data && (data=this->m_cli.find_cluster(token)))
+            {
+                cluster = true;
+            }
+        }
+
+        if (this->parse_short_argument(data, token)
+            || this->parse_list_argument(data, token))
+        {
+            return;
+        }
+
+        if (cluster)
+        {
+            this->parse_cluster(token);
+        }
+        else if (this->parse_option(data, token))
+        {
+            this->parse_argument(data, token);
+        }
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void stream::feed(char** argv)
+    {
+        for (char** argp=argv; *argp != NULL; ++argp)
+        {
+            this->feed(*argp);
+        }
+    }
+
+    /**
+     * @details A short option that was waiting for an argument does not get
+     *          one. A list_argument type option must have been followed by at
+     *          least one more token.
+     */
+    COMMANDLINE_INLINE
+    void stream::finish(void)
+    {
+        if (this->m_pending)
+        {
+            this->emit(this->m_pending, this->m_pending->shortopt, "",
+                       this->m_pendingindex);
+        }
+
+        if (this->m_list && this->m_listempty)
+        {
+            this->fail(missing_list_argument, this->m_listindex,
+                       this->m_listopt);
+        }
+
+        this->m_pending   = NULL;
+        this->m_list      = NULL;
+        this->m_listempty = false;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    bool stream::parse_option(const option_info_t* data, const token_t& token)
+    {
+        if (data)
+        {
+            return true;
+        }
+
+        std::string_view option = token.option();
+        if ((option.size() > 2) && (option.substr(0, 2) == "--"))
+        {
+            interface::prefix_range_t range = this->m_cli.find_prefix(option);
+            if ((range.second - range.first) > 1)
+            {
+                this->fail(ambiguous_option, this->m_current, token.text);
+                return false;
+            }
+        }
+
+        this->fail(invalid_option, this->m_current, token.text);
+        return false;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void stream::parse_argument(const option_info_t* data, const token_t& token)
+    {
+        switch (data->argument)
+        {
+        case commandline::no_argument:
+            this->emit(data, token.text, "", this->m_current);
+            break;
+        case commandline::list_argument:
+            this->m_list      = data;
+            this->m_listindex = this->m_current;
+            this->m_listempty = true;
+            this->m_listopt   = this->m_cli.is_short_option(data, token.text) ?
+                data->shortopt : data->longopt;
+            break;
+        case commandline::optional_argument:
+        case commandline::required_argument:
+        default:
+            if (this->m_cli.is_long_option(data, token))
+            {
+                this->parse_long_argument(data, token);
+            }
+            else if (this->m_cli.is_short_option(data, token.text))
+            {
+                this->m_pending      = data;
+                this->m_pendingindex = this->m_current;
+            }
+            else
+            {
+                this->fail(unknown_option_form, this->m_current, token.text);
+            }
+            break;
+        }
+    }
+
+    /**
+     * @details The argument of a short option is the token after it, unless
+     *          that token is an option itself.
+     */
+    COMMANDLINE_INLINE
+    bool stream::parse_short_argument(const option_info_t* data,
+                                      const token_t& token)
+    {
+        const option_info_t* pending = this->m_pending;
+        if (!pending)
+        {
+            return false;
+        }
+
+        this->m_pending = NULL;
+        if (data)
+        {
+            this->emit(pending, pending->shortopt, "", this->m_pendingindex);
+            return false;
+        }
+
+        this->emit(pending, pending->shortopt, token.text, this->m_current);
+        return true;
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void stream::parse_cluster(const token_t& token)
+    {
+        std::string_view text = token.text;
+        for (size_t i=1; i < text.size(); ++i)
+        {
+            size_t id = this->m_cli.find_short(text[i]);
+            if (id == kNoOption)
+            {
+                this->fail(invalid_option, this->m_current, text);
+                return;
+            }
+
+            const option_info_t*  data  = &this->m_cli.m_options[id];
+            std::string_view value = text.substr(i+1);
+            switch (data->argument)
+            {
+            case commandline::no_argument:
+                this->emit(data, data->shortopt, "", this->m_current);
+                continue;
+            case commandline::list_argument:
+                this->m_list      = data;
+                this->m_listindex = this->m_current;
+                this->m_listempty = value.empty();
+                this->m_listopt   = data->shortopt;
+                if (!value.empty())
+                {
+                    this->emit(data, data->shortopt, value, this->m_current);
+                }
+                return;
+            case commandline::optional_argument:
+            case commandline::required_argument:
+            default:
+                if (value.empty())
+                {
+                    this->m_pending      = data;
+                    this->m_pendingindex = this->m_current;
+                }
+                else
+                {
+                    this->emit(data, data->shortopt, value, this->m_current);
+                }
+                return;
+            }
+        }
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void stream::parse_long_argument(const option_info_t* data,
+                                     const token_t& token)
+    {
+        this->emit(data, token.option(), token.value(), this->m_current);
+    }
+
+    /**
+     * @details This function is meant to be called for every token after a
+     *          list_argument type option, so as to capture all of its
+     *          arguments, until another option is found.
+     */
+    COMMANDLINE_INLINE
+    bool stream::parse_list_argument(const option_info_t* data,
+                                     const token_t& token)
+    {
+        if (!this->m_list)
+        {
+            return false;
+        }
+
+        this->m_listempty = false;
+        if (data)
+        {
+            this->m_list = NULL;
+            return false;
+        }
+
+        this->emit(this->m_list, this->m_listopt, token.text,
+                   this->m_current);
+        return true;
+    }
+
+    /**
+     * @details Map the whole file read-only, split it on whitespace and NUL
+     *          characters, and feed each argument as a view into the mapping.
+     *          Values are copied only if the callback stores them. Each
+     *          argument is classified in the same scan that splits it.
+     */
+    COMMANDLINE_INLINE
+    void stream::parse_response_file(std::string_view file)
+    {
+        std::string path(file.substr(1));
+        struct stat info;
+        int fd;
+
+        if (this->m_depth >= kResponseFileDepth)
+        {
+            this->fail(response_file_depth, this->m_current, file);
+            return;
+        }
+
+        if (this->m_files >= std::min(this->m_cli.m_limits.response_files,
+                                      kResponseFiles))
+        {
+            this->fail(response_file_count, this->m_current, file);
+            return;
+        }
+
+        if ((fd=open(path.c_str(), O_RDONLY)) < 0)
+        {
+            this->fail(unreadable_response_file, this->m_current, file);
+            return;
+        }
+
+        /* Pipes and devices have no size to map, and may never end. */
+        if ((fstat(fd, &info) < 0) || !S_ISREG(info.st_mode))
+        {
+            close(fd);
+            this->fail(unreadable_response_file, this->m_current, file);
+            return;
+        }
+
+        std::pair<uint64_t, uint64_t> node(info.st_dev, info.st_ino);
+        for (size_t i=0; i < this->m_depth; ++i)
+        {
+            if (this->m_open[i] == node)
+            {
+                close(fd);
+                this->fail(response_file_depth, this->m_current, file);
+                return;
+            }
+        }
+        ++this->m_files;
+
+        size_t size = static_cast<size_t>(info.st_size);
+        void*  map  = (size > 0) ?
+            mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+        close(fd);
+
+        if (map == MAP_FAILED)
+        {
+            this->fail(unreadable_response_file, this->m_current, file);
+            return;
+        }
+
+        madvise(map, size, MADV_SEQUENTIAL);
+        this->m_open[this->m_depth++] = node;
+
+        const char* text  = static_cast<const char*>(map);
+        size_t      start = 0;
+        size_t      i;
+        token_t     token;
+
+        token.dashes = 0;
+        token.equals = std::string_view::npos;
+        for (i=0; i <= size; ++i)
+        {
+            if ((i < size) && (text[i] != '\0') && !isspace(
+                    static_cast<unsigned char>(text[i])))
+            {
+                if ((text[i] == '-') && (token.dashes == i-start))
+                {
+                    ++token.dashes;
+                }
+                else if ((text[i] == '=')
+                         && (token.equals == std::string_view::npos))
+                {
+                    token.equals = i-start;
+                }
+                continue;
+            }
+
+            if (i > start)
+            {
+                token.text = std::string_view(text+start, i-start);
+                this->feed(token);
+            }
+            start        = i+1;
+            token.dashes = 0;
+            token.equals = std::string_view::npos;
+        }
+
+        --this->m_depth;
+        if (map)
+        {
+            munmap(map, size);
+        }
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void stream::emit(const option_info_t* data, std::string_view option,
+                      std::string_view value, size_t index)
+    {
+        event_t event;
+        event.id     = this->m_cli.to_id(data);
+        event.option = option;
+        event.value  = value;
+        event.index  = index;
+
+        COMMANDLINE_TIME(this->m_stats.store);
+        this->m_callback(event);
+    }
+
+    /**
+     */
+    COMMANDLINE_INLINE
+    void stream::fail(errcode_t code, size_t index, std::string_view token)
+    {
+        if (this->m_errors)
+        {
+            this->m_errors->add(code, index);
+            return;
+        }
+
+        int         size = static_cast<int>(token.size());
+        const char* data = token.data();
+        switch (code)
+        {
+        case commandline::invalid_option:
+            fprintf(stderr, "%s: Invalid option '%.*s'\n", program_name(),
+                    size, data);
+            break;
+        case commandline::missing_list_argument:
+            fprintf(stderr,
+                    "%s: No argument after option '%.*s' with list_argument type.\n",
+                    program_name(), size, data);
+            break;
+        case commandline::unknown_option_form:
+            fprintf(stderr,
+                    "%s: Unable to determine if '%.*s' is a long or short option.\n",
+                    program_name(), size, data);
+            break;
+        case commandline::unreadable_response_file:
+            fprintf(stderr, "%s: Unable to read response file '%.*s'.\n",
+                    program_name(), size-1, data+1);
+            break;
+        case commandline::ambiguous_option:
+            fprintf(stderr, "%s: Option '%.*s' is ambiguous; possibilities:",
+                    program_name(), size, data);
+            {
+                interface::prefix_range_t range =
+                    this->m_cli.find_prefix(classify(token).option());
+                for (const prefix_t* it=range.first; it != range.second; ++it)
+                {
+                    fprintf(stderr, " '%.*s'",
+                            static_cast<int>(it->first.size()),
+                            it->first.data());
+                }
+            }
+            fprintf(stderr, "\n");
+            break;
+        case commandline::input_too_large:
+            fprintf(stderr, "%s: Command line too large at '%.*s'.\n",
+                    program_name(), std::min(size, 32), data);
+            break;
+        case commandline::response_file_count:
+            fprintf(stderr, "%s: Too many response files at '%.*s'.\n",
+                    program_name(), size-1, data+1);
+            break;
+        case commandline::response_file_depth:
+            fprintf(stderr, "%s: Response files nested too deeply at '%.*s'.\n",
+                    program_name(), size-1, data+1);
+            break;
+        default:
+            fprintf(stderr, "%s: Invalid argument '%.*s'\n", program_name(),
+                    size, data);
+            break;
+        }
+        exit(1);
+    }
+}
+
+/* The macros are internal to the definitions, so that they do not leak into
+ * the programs that include them. */
+#undef COMMANDLINE_INLINE
+#undef COMMANDLINE_COUNT
+#undef COMMANDLINE_TIME
+#undef COMMANDLINE_PROBES
+#undef COMMANDLINE_PROBE
+
+#endif /* COMMAND_LINE_INL_HPP */
@@ -9,10 +9,27 @@
 #ifndef COMMAND_LINE_HPP
 #define COMMAND_LINE_HPP
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <deque>
+#endif
+
 /**
  * @namespace commandline
  * 
@@ -20,12 +37,6 @@
  */
 namespace commandline
 {
-    /**
-     * @brief Maximum length of an argument name, when printing out program
-     *         usage.
-     */
-    const size_t kArgumentNameLength = 32;
-
     /**
      * @enum argument_t
      * 
@@ -39,6 +50,70 @@ namespace commandline
         list_argument      /**< One or more arguments after an option. */
     };
 
+    /**
+     * @enum value_t
+     * 
+     * @brief The type that the argument(s) of an option are converted to, when
+     *        the command line is parsed.
+     */
+    enum value_t
+    {
+        string_value,   /**< Kept as a string. */
+        integer_value,  /**< A base 10 integer, e.g. '42'. */
+        floating_value, /**< A floating point number, e.g. '0.5'. */
+        duration_value  /**< An integer with a unit, e.g. '250ms', where the
+                             unit is one of: ns, us, ms, s, m, h. */
+    };
+
+    /**
+     * @enum layer_t
+     * 
+     * @brief The source of a value. A value from a later layer replaces the
+     *        values of an earlier one, whatever order they are loaded in.
+     */
+    enum layer_t
+    {
+        default_layer,     /**< A default value set by the program. */
+        config_layer,      /**< A value from a config file. */
+        environment_layer, /**< A value from an environment variable. */
+        command_layer      /**< A value entered on the command line. */
+    };
+
+    /**
+     * @enum shell_t
+     * 
+     * @brief The shell that a completion script is written for.
+     */
+    enum shell_t
+    {
+        bash_shell, /**< Bash, through 'complete -F'. */
+        zsh_shell   /**< Zsh, through '_arguments'. */
+    };
+
+    /**
+     * @brief Position returned by an option lookup when no option matches.
+     */
+    const size_t kNoOption = static_cast<size_t>(-1);
+
+    /**
+     * @brief Set the name of the program, as printed in the usage message and
+     *        in error messages.
+     * 
+     * @details The name defaults to the PROGRAM macro, if it is defined where
+     *          the library is compiled, and to "program" otherwise.
+     * 
+     * @param[in] name The program name, e.g. argv[0]. It must outlive every
+     *                 message that prints it.
+     */
+    void set_program_name(const char* name);
+
+    /**
+     * @brief Retrieve the name of the program.
+     * 
+     * @return The name set by set_program_name(), or the default name.
+     */
+    const char* program_name(void);
+
     /**
      * @struct option
      * 
@@ -47,7 +122,9 @@ namespace commandline
      * 
      * @details All the information about an option, such as: the short form,
      *          long form, argument name, argument type, and a description of
-     *          the option.
+     *          the option. Optionally, the type its value is converted to, and
+     *          constraints that are checked once the command line is parsed.
+     *          Other options are named by any of their option strings or keys.
      */
     struct option
     {
@@ -56,338 +133,3172 @@ namespace commandline
         std::string name;     /**< Name of the argument. */
         argument_t  argument; /**< Type of argument. */
         std::string desc;     /**< Description of the option. */
+        value_t     type = string_value; /**< Type of the value. */
+        std::vector<std::string> conflicts = {}; /**< Options that cannot be
+                                                      entered with this one,
+                                                      both on the command
+                                                      line. */
+        std::vector<std::string> depends   = {}; /**< Options that must be
+                                                      set with this one, from
+                                                      any layer. */
+        std::vector<std::string> choices   = {}; /**< The only values allowed,
+                                                      if not empty. */
+        double minimum = -std::numeric_limits<double>::infinity(); /**<
+                                      Smallest value allowed, for integer and
+                                      floating point values. */
+        double maximum = std::numeric_limits<double>::infinity(); /**<
+                                      Largest value allowed, for integer and
+                                      floating point values. */
+        size_t min_values = 0;         /**< Fewest values allowed, when the
+                                            option is entered. */
+        size_t max_values = kNoOption; /**< Most values allowed. */
+    };
+
+    /**
+     * @brief Type name for an option.
+     */
+    typedef struct option option_t;
+
+    /**
+     * @brief Type name for a list of all options in a program.
+     */
+    typedef std::vector<option_t> optlist_t;
+
+    /**
+     * @brief Type name for an index of option strings, mapped to the position
+     *        of their option in an option list.
+     */
+    typedef std::unordered_map<std::string_view, size_t> strindex_t;
+
+    /**
+     * @brief Type name for a long option string, and the position of its
+     *        option in an option list.
+     */
+    typedef std::pair<std::string_view, size_t> prefix_t;
+
+    /**
+     * @brief Type name for a list of long option strings, sorted so that the
+     *        options that start with a prefix are next to each other.
+     */
+    typedef std::vector<prefix_t> prefixes_t;
+
+    /**
+     * @brief Type name for a table that maps every character c to the
+     *        position of the option with the short option '-c'.
+     */
+    typedef std::array<size_t, 256> shortindex_t;
+
+    /**
+     * @brief Type name for list of all entered options and their respective
+     *        values.
+     */
+    typedef std::unordered_map<std::string, std::vector<std::string>> keyval_t;
+
+    /**
+     * @brief Type name for a value that has been converted from a string.
+     */
+    typedef std::variant<std::monostate, long long, double,
+                         std::chrono::nanoseconds> typedval_t;
+
+    /**
+     * @brief Type name for the ID of an option, which is its position in the
+     *        list of all options.
+     */
+    typedef size_t optid_t;
+
+    /**
+     * @struct result
+     * 
+     * @brief The values entered on the command line for one option.
+     * 
+     * @details The values and their strings are allocated from the memory
+     *          resource of the allocator the result is constructed with.
+     */
+    struct result
+    {
+        /**
+         * @brief Type name for the allocator of the values.
+         */
+        typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+        /**
+         * @brief Construct an empty result.
+         * 
+         * @param[in] alloc Allocator for the values.
+         */
+        explicit result(const allocator_type& alloc = {}) : values(alloc)
+        {
+        }
+
+        /**
+         * @brief Copy a result, with the given allocator.
+         * 
+         * @param[in] other The result to copy.
+         * @param[in] alloc Allocator for the values.
+         */
+        result(const result& other, const allocator_type& alloc)
+            : values(other.values, alloc),
+              value(other.value),
+              layer(other.layer)
+        {
+        }
+
+        std::pmr::vector<std::pmr::string> values; /**< Values, in the order
+                                                        entered. */
+        typedval_t value; /**< First value, converted to the type of the
+                               option. Only set for options that are not of
+                               string_value type, and have a non-empty
+                               value. */
+        layer_t    layer = default_layer; /**< Source of the values. */
+    };
+
+    /**
+     * @brief Type name for the values of one option.
+     */
+    typedef struct result result_t;
+
+    /**
+     * @struct token
+     * 
+     * @brief A command line argument, classified in a single scan, so that it
+     *        does not need to be scanned again to look it up or split it.
+     */
+    struct token
+    {
+        std::string_view text;   /**< The whole argument. */
+        size_t           dashes; /**< Number of leading dashes. */
+        size_t           equals; /**< Position of the first '=', or npos. */
+
+        /**
+         * @brief The section before the '=', e.g. '--long-option' in
+         *        '--long-option=value', or the whole argument if there is no
+         *        '='.
+         */
+        std::string_view option(void) const
+        {
+            return this->text.substr(0, this->equals);
+        }
+
+        /**
+         * @brief The section after the '=', or an empty string if there is no
+         *        '='.
+         */
+        std::string_view value(void) const
+        {
+            return (this->equals == std::string_view::npos) ? ""
+                : this->text.substr(this->equals+1);
+        }
+    };
+
+    /**
+     * @brief Type name for a classified command line argument.
+     */
+    typedef struct token token_t;
+
+    /**
+     * @brief Classify a command line argument.
+     * 
+     * @param[in] text The command line argument.
+     * 
+     * @return The classified argument.
+     */
+    token_t classify(std::string_view text);
+
+    /**
+     * @enum errcode_t
+     * 
+     * @brief The kind of error found while parsing the command line.
+     */
+    enum errcode_t
+    {
+        no_error,                 /**< No error. */
+        invalid_option,           /**< An argument that is not an option. */
+        missing_list_argument,    /**< A list_argument type option, as the
+                                       last argument. */
+        unknown_option_form,      /**< An option that is neither in its long
+                                       nor its short form. */
+        invalid_value,            /**< A value that cannot be converted to
+                                       the type of its option. */
+        unreadable_response_file, /**< A response file that cannot be read,
+                                       or is not a regular file. */
+        response_file_depth,      /**< Response files nested too deeply, or
+                                       a response file that includes itself. */
+        ambiguous_option,         /**< An abbreviated long option that is the
+                                       prefix of more than one option. */
+        conflicting_options,      /**< Two options that cannot be entered
+                                       together. */
+        missing_requirement,      /**< An option entered without an option
+                                       it depends on. */
+        invalid_choice,           /**< A value that is not one of the choices
+                                       of its option. */
+        out_of_range,             /**< A value outside the range of its
+                                       option. */
+        wrong_value_count,        /**< An option with too few or too many
+                                       values. */
+        input_too_large,          /**< A command line over one of the
+                                       limits of the interface. */
+        response_file_count       /**< More response files than one command
+                                       line can read. */
+    };
+
+    /**
+     * @brief Maximum number of errors that are kept by a single parse.
+     */
+    const size_t kMaxErrors = 16;
+
+    /**
+     * @struct parse_error
+     * 
+     * @brief An error found while parsing the command line.
+     */
+    struct parse_error
+    {
+        errcode_t code;   /**< The kind of error. */
+        size_t    index;  /**< Position of the offending argument in argv,
+                               or 0 if the error is about the whole command
+                               line, e.g. a constraint. An error inside a
+                               response file is at its '@file' argument. */
+        optid_t   option; /**< ID of the option the error is about, or
+                               kNoOption. */
+    };
+
+    /**
+     * @brief Type name for an error found while parsing.
+     */
+    typedef struct parse_error parse_error_t;
+
+    /**
+     * @struct errors
+     * 
+     * @brief The errors found while parsing the command line, in a fixed size
+     *        array, so that collecting them never allocates.
+     */
+    struct errors
+    {
+        parse_error_t list[kMaxErrors]; /**< The first kMaxErrors errors. */
+        size_t        count = 0;        /**< Number of errors found, which may
+                                             be more than are kept. */
+
+        /**
+         * @brief Add an error. It is only kept if there is room for it.
+         * 
+         * @param[in] code   The kind of error.
+         * @param[in] index  Position of the offending argument.
+         * @param[in] option ID of the option the error is about.
+         */
+        void add(errcode_t code, size_t index, optid_t option = kNoOption)
+        {
+            if (this->count < kMaxErrors)
+            {
+                this->list[this->count] = {code, index, option};
+            }
+            ++this->count;
+        }
+    };
+
+    /**
+     * @brief Type name for the errors found while parsing.
+     */
+    typedef struct errors errors_t;
+
+    /**
+     * @brief Maximum number of response files that can be nested inside one
+     *        another.
+     */
+    const size_t kResponseFileDepth = 16;
+
+    /**
+     * @brief Maximum number of response files that one command line can read,
+     *        so that a few files that include each other many times cannot
+     *        expand exponentially.
+     */
+    const size_t kResponseFiles = 256;
+
+    /**
+     * @struct limits
+     * 
+     * @brief Bounds on the size of a command line, for parsing input that is
+     *        not trusted.
+     * 
+     * @details The parser runs in time linear in the number of bytes it reads,
+     *          from the arguments and from the response files they name, and
+     *          stores each value once. These bound both the time and the memory
+     *          a command line can take. The bounds on the arguments are off by
+     *          default. Response files are off by default too, so that an
+     *          argument or a value that starts with '@' is parsed as it is,
+     *          and a command line cannot make the program read a file unless
+     *          it asks for it. They are always bounded when turned on.
+     */
+    struct limits
+    {
+        size_t tokens     = kNoOption; /**< Most arguments, including those read
+                                            from response files. */
+        size_t token_size = kNoOption; /**< Longest argument, in bytes. */
+        size_t values     = kNoOption; /**< Most values of one option. */
+        size_t response_files = 0;     /**< Most response files read, at most
+                                            kResponseFiles. If 0, an '@file'
+                                            argument is parsed as any other
+                                            argument. */
+    };
+
+    /**
+     * @brief Type name for the bounds on the size of a command line.
+     */
+    typedef struct limits limits_t;
+
+    /**
+     * @struct stats
+     * 
+     * @brief Counters and phase timings of a parse, to find the command lines
+     *        that are slow to parse.
+     * 
+     * @details They are only collected when COMMANDLINE_STATS is defined.
+     *          Otherwise, no counter is kept, and the instrumentation compiles
+     *          to nothing.
+     */
+    struct stats
+    {
+        size_t                   tokens      = 0; /**< Tokens fed. */
+        size_t                   probes      = 0; /**< Option lookups, i.e.
+                                                       hash lookups, prefix
+                                                       searches and short
+                                                       option lookups. */
+        size_t                   allocations = 0; /**< Allocations made to
+                                                       store values. */
+        size_t                   bytes       = 0; /**< Bytes of values
+                                                       copied. */
+        std::chrono::nanoseconds tokenise{0};     /**< Time spent classifying
+                                                       tokens. */
+        std::chrono::nanoseconds resolve{0};      /**< Time spent looking up
+                                                       options. */
+        std::chrono::nanoseconds store{0};        /**< Time spent handling
+                                                       events, e.g. storing
+                                                       values. */
+
+        /**
+         * @brief Add the counters and timings of other to these.
+         * 
+         * @param[in] other Another set of statistics.
+         */
+        void add(const stats& other)
+        {
+            this->tokens      += other.tokens;
+            this->probes      += other.probes;
+            this->allocations += other.allocations;
+            this->bytes       += other.bytes;
+            this->tokenise    += other.tokenise;
+            this->resolve     += other.resolve;
+            this->store       += other.store;
+        }
+    };
+
+    /**
+     * @brief Type name for the statistics of a parse.
+     */
+    typedef struct stats stats_t;
+
+    /**
+     * @struct event
+     * 
+     * @brief An option, and one of its values, as found in the command line.
+     */
+    struct event
+    {
+        optid_t          id;     /**< ID of the option. */
+        std::string_view option; /**< Short or long option string, as it was
+                                      entered, without any '=value'. */
+        std::string_view value;  /**< The value. Empty if there is none. It
+                                      is only valid while the event is being
+                                      handled. */
+        size_t           index;  /**< Position of the argument that holds
+                                      the value, among those fed. A value
+                                      read from a response file is at its
+                                      '@file' argument. */
+    };
+
+    /**
+     * @brief Type name for an option and its value.
+     */
+    typedef struct event event_t;
+
+    /**
+     * @brief Check if a type is an instance of std::chrono::duration.
+     */
+    template <typename T>
+    struct is_duration : std::false_type
+    {
+    };
+
+    /**
+     * @brief Check if a type is an instance of std::chrono::duration.
+     */
+    template <typename Rep, typename Period>
+    struct is_duration<std::chrono::duration<Rep, Period>> : std::true_type
+    {
+    };
+
+    /**
+     * @struct static_option
+     * 
+     * @brief A compile-time counterpart of the option struct.
+     * 
+     * @details Holds the same information as an option, as views into string
+     *          literals, so that a whole option list can be declared constexpr
+     *          and checked with static_assert.
+     */
+    struct static_option
+    {
+        std::string_view shortopt; /**< Short form of the option. */
+        std::string_view longopt;  /**< Long form of the option. */
+        std::string_view name;     /**< Name of the argument. */
+        argument_t       argument; /**< Type of argument. */
+        std::string_view desc;     /**< Description of the option. */
+        value_t          type = string_value; /**< Type of the value. */
+    };
+
+    /**
+     * @brief Type name for a compile-time option.
+     */
+    typedef struct static_option static_option_t;
+
+    /**
+     * @brief Type name for a compile-time list of all options in a program.
+     */
+    template <size_t N>
+    using static_optlist_t = std::array<static_option_t, N>;
+
+    /**
+     * @struct option_info
+     * 
+     * @brief The part of an option that is needed to parse a command line,
+     *        i.e. all of it but its description.
+     * 
+     * @details Descriptions are only needed by usage(), so a catalog keeps
+     *          them apart, and the options that are looked up while parsing
+     *          take fewer cache lines.
+     */
+    struct option_info
+    {
+        std::string_view shortopt; /**< Short form of the option. */
+        std::string_view longopt;  /**< Long form of the option. */
+        std::string_view name;     /**< Name of the argument. */
+        argument_t       argument; /**< Type of argument. */
+        value_t          type;     /**< Type of the value. */
+    };
+
+    /**
+     * @brief Type name for the part of an option needed to parse.
+     */
+    typedef struct option_info option_info_t;
+
+    /**
+     * @struct lookup
+     * 
+     * @brief Functions that resolve an option string, or a key, to the
+     *        position of its option in the option list.
+     * 
+     * @details The functions return kNoOption when nothing matches. They are
+     *          used in place of the tables an interface builds on its own.
+     */
+    struct lookup
+    {
+        size_t (*find)(std::string_view option); /**< Find an option string. */
+        size_t (*find_key)(std::string_view key); /**< Find a key. */
+        size_t (*find_short)(char c); /**< Find the short option '-c'. */
     };
 
-    /**
-     * @brief Type name for an option.
-     */
-    typedef struct option option_t;
+    /**
+     * @brief Type name for the option lookup functions.
+     */
+    typedef struct lookup lookup_t;
+
+    /**
+     * @brief Hash a string with the FNV-1a algorithm, followed by a final mix
+     *        of the bits.
+     * 
+     * @param[in] str  The string to hash.
+     * @param[in] seed Value mixed into the initial hash state.
+     * 
+     * @return The hash of the string.
+     */
+    constexpr uint32_t fnv1a(std::string_view str, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char c : str)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bu;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35u;
+        hash ^= hash >> 16;
+        return hash;
+    }
+
+    /**
+     * @brief Check that a short option is empty, or a single dash followed by
+     *        a name that does not contain an '='.
+     * 
+     * @param[in] option A short option string.
+     * 
+     * @return true if the short option is well formed, and false otherwise.
+     */
+    constexpr bool is_valid_short_option(std::string_view option)
+    {
+        return (option.empty()
+                || ((option.size() >= 2) && (option[0] == '-')
+                    && (option[1] != '-')
+                    && (option.find('=') == std::string_view::npos)));
+    }
+
+    /**
+     * @brief Check that a long option is empty, or two dashes followed by a
+     *        name that does not contain an '='.
+     * 
+     * @param[in] option A long option string.
+     * 
+     * @return true if the long option is well formed, and false otherwise.
+     */
+    constexpr bool is_valid_long_option(std::string_view option)
+    {
+        return (option.empty()
+                || ((option.size() >= 3) && (option.substr(0, 2) == "--")
+                    && (option[2] != '-')
+                    && (option.find('=') == std::string_view::npos)));
+    }
+
+    /**
+     * @brief Check that every option in a compile-time list has a short or long
+     *        form, and that both are well formed.
+     * 
+     * @param[in] options A compile-time option list.
+     * 
+     * @return true if all options are well formed, and false otherwise.
+     */
+    template <size_t N>
+    constexpr bool has_valid_dashes(const static_optlist_t<N>& options)
+    {
+        for (const static_option_t& data : options)
+        {
+            if ((data.shortopt.empty() && data.longopt.empty())
+                || !is_valid_short_option(data.shortopt)
+                || !is_valid_long_option(data.longopt))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Check that no two options in a compile-time list share a short or
+     *        a long form.
+     * 
+     * @param[in] options A compile-time option list.
+     * 
+     * @return true if all options are unique, and false otherwise.
+     */
+    template <size_t N>
+    constexpr bool has_unique_options(const static_optlist_t<N>& options)
+    {
+        uint32_t shorthash[N] = {};
+        uint32_t longhash[N]  = {};
+        size_t   i            = 0;
+
+        for (i=0; i < N; ++i)
+        {
+            shorthash[i] = fnv1a(options[i].shortopt, 0);
+            longhash[i]  = fnv1a(options[i].longopt, 0);
+        }
+
+        for (i=0; i < N; ++i)
+        {
+            for (size_t j=i+1; j < N; ++j)
+            {
+                if (((shorthash[i] == shorthash[j])
+                     && !options[i].shortopt.empty()
+                     && (options[i].shortopt == options[j].shortopt))
+                    || ((longhash[i] == longhash[j])
+                        && !options[i].longopt.empty()
+                        && (options[i].longopt == options[j].longopt)))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Convert a compile-time option list to a regular option list.
+     * 
+     * @param[in] options A compile-time option list.
+     * 
+     * @return The option list.
+     */
+    template <size_t N>
+    optlist_t to_optlist(const static_optlist_t<N>& options)
+    {
+        optlist_t list;
+        list.reserve(N);
+        for (const static_option_t& data : options)
+        {
+            list.push_back({std::string(data.shortopt),
+                            std::string(data.longopt),
+                            std::string(data.name),
+                            data.argument,
+                            std::string(data.desc),
+                            data.type});
+        }
+        return list;
+    }
+
+    /**
+     * @struct rules
+     * 
+     * @brief The constraints of an option that are not between options.
+     */
+    struct rules
+    {
+        double minimum;      /**< Smallest value allowed. */
+        double maximum;      /**< Largest value allowed. */
+        size_t min_values;   /**< Fewest values allowed. */
+        size_t max_values;   /**< Most values allowed. */
+        size_t first_choice; /**< Position of its first choice. */
+        size_t choices;      /**< Number of choices. */
+    };
+
+    /**
+     * @brief Type name for the constraints of an option.
+     */
+    typedef struct rules rules_t;
+
+    /**
+     * @class catalog
+     * 
+     * @brief An immutable list of options, which can be shared by any number
+     *        of command line interfaces.
+     * 
+     * @details Every string of the options is interned once into a single
+     *          pool, so that options that share a string, e.g. a description,
+     *          store it once, and each option is a compact set of views into
+     *          the pool. The descriptions are kept apart from the rest of the
+     *          options, at the end of the pool and in their own array, as they
+     *          are only needed to print the usage message.
+     * 
+     *          Constraints between options are compiled into bitsets over
+     *          option IDs, one row per option, so that they can be checked
+     *          with a few word operations.
+     */
+    class catalog
+    {
+    public:
+        /**
+         * @brief Construct a catalog, from a copy of the strings of a list of
+         *        options.
+         * 
+         * @details Exit the program if a constraint names an unknown option.
+         * 
+         * @param[in] options List of all command line options for the
+         *                    program.
+         */
+        explicit catalog(const optlist_t& options);
+
+        /**
+         * @brief Construct a catalog that views arrays of options and of
+         *        descriptions in place, without copying them.
+         * 
+         * @param[in] options Array of options, with static storage duration.
+         * @param[in] descs   Array of the description of each option, with
+         *                    static storage duration.
+         * @param[in] size    Number of options.
+         */
+        catalog(const option_info_t* options, const std::string_view* descs,
+                size_t size)
+            : m_data(options),
+              m_desc(descs),
+              m_size(size),
+              m_words(0),
+              m_flags(size > 0)
+        {
+            for (size_t i=0; i < size; ++i)
+            {
+                this->m_flags = this->m_flags
+                    && (options[i].argument == no_argument);
+            }
+        }
+
+        catalog(const catalog&) = delete;
+        catalog& operator=(const catalog&) = delete;
+
+        /**
+         * @brief Retrieve the number of options.
+         */
+        size_t size(void) const
+        {
+            return this->m_size;
+        }
+
+        /**
+         * @brief Retrieve the first option.
+         */
+        const option_info_t* data(void) const
+        {
+            return this->m_data;
+        }
+
+        /**
+         * @brief Retrieve the option at the given position.
+         */
+        const option_info_t& operator[](size_t i) const
+        {
+            return this->m_data[i];
+        }
+
+        /**
+         * @brief Iterate over the options.
+         */
+        const option_info_t* begin(void) const
+        {
+            return this->m_data;
+        }
+
+        /**
+         * @brief End of the options.
+         */
+        const option_info_t* end(void) const
+        {
+            return this->m_data + this->m_size;
+        }
+
+        /**
+         * @brief Retrieve the description of the option at the given
+         *        position.
+         */
+        std::string_view desc(size_t i) const
+        {
+            return this->m_desc[i];
+        }
+
+        /**
+         * @brief Check if every option is a flag, of no_argument type.
+         */
+        bool flags(void) const
+        {
+            return this->m_flags;
+        }
+
+        /**
+         * @brief Check if any option has a constraint.
+         */
+        bool constrained(void) const
+        {
+            return !this->m_rules.empty();
+        }
+
+        /**
+         * @brief Retrieve the number of 64 bit words in a row of a bitset.
+         */
+        size_t words(void) const
+        {
+            return this->m_words;
+        }
+
+        /**
+         * @brief Retrieve the bitset of the options that conflict with the
+         *        option at the given position.
+         */
+        const uint64_t* conflicts(size_t i) const
+        {
+            return &this->m_conflicts[i*this->m_words];
+        }
+
+        /**
+         * @brief Retrieve the bitset of the options that the option at the
+         *        given position depends on.
+         */
+        const uint64_t* depends(size_t i) const
+        {
+            return &this->m_depends[i*this->m_words];
+        }
+
+        /**
+         * @brief Retrieve the other constraints of the option at the given
+         *        position.
+         */
+        const rules_t& rules(size_t i) const
+        {
+            return this->m_rules[i];
+        }
+
+        /**
+         * @brief Retrieve a choice, at the given position among those of
+         *        every option.
+         */
+        std::string_view choice(size_t i) const
+        {
+            return this->m_choices[i];
+        }
+
+    private:
+        /**
+         * @brief Compile the constraints of the options into bitsets over
+         *        option IDs, and the rules of each option.
+         * 
+         * @param[in] options List of all command line options for the
+         *                    program, in the same order as the catalog.
+         */
+        void compile(const optlist_t& options);
+
+        /**
+         * @brief The pool of option strings, when they are copied.
+         */
+        std::string m_pool;
+
+        /**
+         * @brief The options, as views into m_pool, when they are copied.
+         */
+        std::vector<option_info_t> m_options;
+
+        /**
+         * @brief The descriptions, as views into m_pool, when they are
+         *        copied.
+         */
+        std::vector<std::string_view> m_descs;
+
+        /**
+         * @brief The options.
+         */
+        const option_info_t* m_data;
+
+        /**
+         * @brief The description of each option.
+         */
+        const std::string_view* m_desc;
+
+        /**
+         * @brief Number of options.
+         */
+        size_t m_size;
+
+        /**
+         * @brief Number of 64 bit words in a row of a bitset.
+         */
+        size_t m_words;
+
+        /**
+         * @brief Whether every option is a flag.
+         */
+        bool m_flags;
+
+        /**
+         * @brief Rows of conflicting options, one per option.
+         */
+        std::vector<uint64_t> m_conflicts;
+
+        /**
+         * @brief Rows of required options, one per option.
+         */
+        std::vector<uint64_t> m_depends;
+
+        /**
+         * @brief The other constraints of every option, or empty if no option
+         *        has a constraint.
+         */
+        std::vector<rules_t> m_rules;
+
+        /**
+         * @brief The choices of every option, as views into m_pool.
+         */
+        std::vector<std::string_view> m_choices;
+    };
+
+    /**
+     * @brief Type name for a shared, immutable list of options.
+     */
+    typedef std::shared_ptr<const catalog> catalog_t;
+
+    /**
+     * @struct hash_entry
+     * 
+     * @brief A string in a perfect hash table, and the position of the option
+     *        it belongs to.
+     */
+    struct hash_entry
+    {
+        std::string_view key; /**< String that is hashed. */
+        size_t           id = kNoOption; /**< Position of the option. */
+    };
+
+    /**
+     * @class perfect_hash
+     * 
+     * @brief A perfect hash table, built at compile time with the hash and
+     *        displace method.
+     * 
+     * @details Strings are first split into buckets by one hash. The largest
+     *          buckets are placed first, by searching for a seed that moves
+     *          every string in the bucket to a free slot when mixed into a
+     *          second hash. A lookup is then two hashes and one string
+     *          comparison.
+     * 
+     * @tparam S Maximum number of strings in the table.
+     */
+    template <size_t S>
+    class perfect_hash
+    {
+    public:
+        /**
+         * @brief Build the perfect hash table.
+         * 
+         * @param[in] entries Strings to place in the table. Entries with an
+         *                    empty key are skipped. Keys must be unique.
+         */
+        constexpr perfect_hash(const std::array<hash_entry, S>& entries)
+        {
+            uint32_t hash[S]        = {};
+            size_t   order[S]       = {};
+            size_t   start[kBuckets+1] = {};
+            size_t   fill[kBuckets] = {};
+            size_t   largest        = 0;
+            size_t   i              = 0;
+            size_t   b              = 0;
+
+            for (i=0; i < S; ++i)
+            {
+                if (!entries[i].key.empty())
+                {
+                    ++start[(fnv1a(entries[i].key, 0) & (kBuckets-1)) + 1];
+                    hash[i] = fnv1a(entries[i].key, 1);
+                }
+            }
+
+            for (b=0; b < kBuckets; ++b)
+            {
+                largest = (start[b+1] > largest) ? start[b+1] : largest;
+                start[b+1] += start[b];
+            }
+
+            for (i=0; i < S; ++i)
+            {
+                if (!entries[i].key.empty())
+                {
+                    b = fnv1a(entries[i].key, 0) & (kBuckets-1);
+                    order[start[b] + fill[b]++] = i;
+                }
+            }
+
+            for (size_t size=largest; size > 0; --size)
+            {
+                for (b=0; b < kBuckets; ++b)
+                {
+                    if ((start[b+1] - start[b]) != size)
+                    {
+                        continue;
+                    }
+
+                    uint32_t seed = 1;
+                    while (!this->place(entries, hash, order+start[b], size,
+                                        seed))
+                    {
+                        ++seed;
+                    }
+                    this->m_seeds[b] = seed;
+                }
+            }
+        }
+
+        /**
+         * @brief Find a string in the table.
+         * 
+         * @param[in] key The string to search for.
+         * 
+         * @return The position of the option the string belongs to. Otherwise,
+         *         return kNoOption.
+         */
+        constexpr size_t find(std::string_view key) const
+        {
+            uint32_t seed = this->m_seeds[fnv1a(key, 0) & (kBuckets-1)];
+            const hash_entry& entry = this->m_slots[slot(fnv1a(key, 1), seed)];
+            return ((entry.id != kNoOption) && (entry.key == key)) ?
+                entry.id : kNoOption;
+        }
+
+    private:
+        /**
+         * @brief Smallest power of two that is not less than the given value.
+         */
+        static constexpr size_t ceil2(size_t value)
+        {
+            size_t power = 1;
+            while (power < value)
+            {
+                power <<= 1;
+            }
+            return power;
+        }
+
+        static constexpr size_t kSlots   = ceil2(2*S); /**< Table size. */
+        static constexpr size_t kBuckets = ceil2(S);   /**< Bucket count. */
+
+        std::array<uint32_t, kBuckets> m_seeds{};  /**< Seed of each bucket. */
+        std::array<hash_entry, kSlots> m_slots{};  /**< Table slots. */
+
+        /**
+         * @brief Determine the slot of a string, from its second hash and the
+         *        seed of its bucket.
+         */
+        static constexpr size_t slot(uint32_t hash, uint32_t seed)
+        {
+            hash ^= seed * 0x9e3779b9u;
+            hash ^= hash >> 16;
+            hash *= 0x85ebca6bu;
+            hash ^= hash >> 13;
+            return hash & (kSlots-1);
+        }
+
+        /**
+         * @brief Try to place every string of a bucket in a free slot, using
+         *        the given seed. Undo the placement if any of them collide.
+         * 
+         * @return true if the whole bucket was placed, and false otherwise.
+         */
+        constexpr bool place(const std::array<hash_entry, S>& entries,
+                             const uint32_t* hash, const size_t* members,
+                             size_t size, uint32_t seed)
+        {
+            for (size_t i=0; i < size; ++i)
+            {
+                hash_entry& entry = this->m_slots[slot(hash[members[i]], seed)];
+                if (entry.id == kNoOption)
+                {
+                    entry = entries[members[i]];
+                    continue;
+                }
+
+                for (size_t j=0; j < i; ++j)
+                {
+                    this->m_slots[slot(hash[members[j]], seed)] = hash_entry();
+                }
+                return false;
+            }
+            return true;
+        }
+    };
+
+    /**
+     * @brief Identifies a flat image of parse results.
+     */
+    const uint32_t kImageMagic = 0x31524c43;
+
+    /**
+     * @struct image_header
+     * 
+     * @brief Header of a flat image of parse results, followed by its entries,
+     *        its values, and the pool of value strings.
+     * 
+     * @details The image only holds offsets, so it can be copied to shared
+     *          memory, sent through a pipe, or written to a file, and read in
+     *          place by another process with the same options. Integers are in
+     *          the byte order of the host, and the image must start on an 8
+     *          byte boundary to be read in place.
+     */
+    struct image_header
+    {
+        uint32_t magic;       /**< kImageMagic. */
+        uint32_t options;     /**< Number of options it was made for. */
+        uint64_t fingerprint; /**< Fingerprint of those options. */
+        uint32_t entries;     /**< Number of entries. */
+        uint32_t values;      /**< Number of values. */
+        uint32_t pool;        /**< Size of the string pool. */
+        uint32_t reserved;    /**< Zero. */
+    };
+
+    /**
+     * @struct image_entry
+     * 
+     * @brief The results of one option in a flat image. Entries are sorted by
+     *        option ID.
+     */
+    struct image_entry
+    {
+        uint32_t id;       /**< Option ID. */
+        uint32_t layer;    /**< Source of the values. */
+        uint32_t first;    /**< Position of its first value. */
+        uint32_t count;    /**< Number of values. */
+        uint32_t type;     /**< Index of the converted value's alternative. */
+        uint32_t reserved; /**< Zero. */
+        uint64_t payload;  /**< Bits of the converted value. */
+    };
+
+    /**
+     * @struct image_value
+     * 
+     * @brief A value in a flat image, as a view into the string pool, where it
+     *        is followed by a NUL character.
+     */
+    struct image_value
+    {
+        uint32_t offset; /**< Offset of the string in the pool. */
+        uint32_t size;   /**< Length of the string, without its NUL. */
+    };
+
+    /**
+     * @brief Check that a flat image is well formed, and was made for the
+     *        given options.
+     * 
+     * @param[in] image       The image.
+     * @param[in] fingerprint Fingerprint of the options, see
+     *                        interface::fingerprint().
+     * @param[in] options     Number of options.
+     * 
+     * @return true if the image can be read. Otherwise, return false.
+     */
+    bool validate_image(std::string_view image, uint64_t fingerprint,
+                        size_t options);
+
+    /**
+     * @brief Decode the converted value of an image entry.
+     * 
+     * @param[in] entry An entry of a valid image.
+     * 
+     * @return The converted value.
+     */
+    typedval_t decode_value(const image_entry& entry);
+
+    /**
+     * @brief Retrieve a converted value as the given type.
+     * 
+     * @tparam    T     The type to retrieve the value as.
+     * @param[in] value The converted value, or NULL.
+     * 
+     * @return See interface::get<T>().
+     */
+    template <typename T>
+    T from_value(const typedval_t* value);
+
+    class stream;
+    class results_view;
+
+    /**
+     * @class interface
+     * 
+     * @brief Interface to the command line, where a user will parse command
+     *        line options, print program usage, etc.
+     */
+    class interface
+    {
+        friend class stream;
+        friend class results_view;
+
+    public:
+        /**
+         * @brief Construct the command line interface.
+         * 
+         * @details Parse results, i.e. the value lists and their strings, are
+         *          allocated from the given memory resource. Passing a
+         *          std::pmr::monotonic_buffer_resource keeps them in one
+         *          contiguous region, that is released all at once when the
+         *          resource is destroyed.
+         * 
+         * @param[in] options  List of all command line options for the
+         *                     program. Its strings are interned into a new
+         *                     catalog.
+         * @param[in] resource Memory resource for the parse results. It must
+         *                     outlive the interface.
+         */
+        explicit interface(const optlist_t& options,
+                           std::pmr::memory_resource* resource
+                               = std::pmr::get_default_resource());
+
+        /**
+         * @brief Construct the command line interface, from a list of options
+         *        that is shared with other interfaces.
+         * 
+         * @details The options are neither copied nor modified, so many
+         *          parsers can be built from one catalog.
+         * 
+         * @param[in] options  List of all command line options for the
+         *                     program. It must not be NULL.
+         * @param[in] resource Memory resource for the parse results. It must
+         *                     outlive the interface.
+         */
+        explicit interface(catalog_t options,
+                           std::pmr::memory_resource* resource
+                               = std::pmr::get_default_resource());
+
+        /**
+         * @brief Construct the command line interface, with the results of a
+         *        flat image made by serialize(), e.g. in another process.
+         * 
+         * @details The values are copied from the image. Exit the program if
+         *          the image is malformed, or was made for other options. Use
+         *          results_view to read an image in place instead.
+         * 
+         * @param[in] options  List of all command line options for the
+         *                     program.
+         * @param[in] image    The image.
+         * @param[in] resource Memory resource for the parse results. It must
+         *                     outlive the interface.
+         */
+        interface(const optlist_t& options, std::string_view image,
+                  std::pmr::memory_resource* resource
+                      = std::pmr::get_default_resource());
+
+        /**
+         * @brief Copy the command line interface.
+         * 
+         * @details The copy shares the option list, and with it the views
+         *          held by the option index, so no option is copied. The copy
+         *          allocates its parse results from the default memory
+         *          resource.
+         * 
+         * @param[in] other The command line interface to copy.
+         */
+        interface(const interface& other);
+
+        /**
+         * @brief Print the program usage message.
+         * 
+         * @details The message is rendered once, and written to stdout with a
+         *          single write().
+         * 
+         * @note The program name is that of program_name().
+         */
+        void usage(void);
+
+        /**
+         * @brief Retrieve the program usage message.
+         * 
+         * @details The message is rendered the first time it is requested, and
+         *          kept for the lifetime of the interface. Short options are
+         *          padded, so that long options line up in one column.
+         * 
+         * @return A view of the usage message.
+         */
+        std::string_view usage_text(void);
+
+        /**
+         * @brief Read the descriptions of the options from a help file, in
+         *        place of those of the catalog.
+         * 
+         * @details The file is only read when the usage message is rendered,
+         *          e.g. when '--help' is entered, so that the descriptions do
+         *          not need to be in memory otherwise. Each line is of the form
+         *          'key description', e.g. 'jobs Number of parallel jobs.' for
+         *          '--jobs'. The file is ignored if it cannot be read.
+         * 
+         * @param[in] path Path of the help file.
+         */
+        void set_help_file(std::string_view path);
+
+        /**
+         * @brief Find the option strings that start with a prefix, for shell
+         *        completion.
+         * 
+         * @details A prefix of a long option is answered from the sorted index
+         *          of long options, with two binary searches. Any other prefix,
+         *          e.g. '-' or an empty one, is matched against every option
+         *          string, in the order of the options.
+         * 
+         * @param[in] prefix The word being completed.
+         * 
+         * @return The matching option strings, which view the catalog.
+         */
+        std::vector<std::string_view> completions(std::string_view prefix) const;
+
+        /**
+         * @brief Answer a completion request, if the command line is one.
+         * 
+         * @details A command line of the form 'program --complete <prefix>'
+         *          prints completions() of the prefix, one per line, and
+         *          'program --completion-script <bash|zsh>' prints the
+         *          completion_script() of that shell. Call this first in main(),
+         *          so that completion skips the startup of the program.
+         * 
+         * @param[in] argv List of command line arguments.
+         * 
+         * @return true if the command line was a completion request, and was
+         *         answered. Otherwise, return false.
+         */
+        bool complete(char** argv) const;
+
+        /**
+         * @brief Write a static completion script for a shell, which completes
+         *        the options without running the program.
+         * 
+         * @details The script lists every option string, and for zsh, the
+         *          description and argument name of each option. It is meant to
+         *          be written once, e.g. when the program is built or
+         *          installed.
+         * 
+         * @param[in]  shell  The shell that the script is written for.
+         * @param[out] script Where the script is appended.
+         */
+        void completion_script(shell_t shell, std::string& script) const;
+
+        /**
+         * @brief Parse the list of arguments given on the command line.
+         * 
+         * @param[in] argv List of command line arguments, typically from the
+         *                 main(argc, argv) function.
+         */
+        void parse(char** argv);
+
+        /**
+         * @brief Parse the list of arguments given on the command line,
+         *        without exiting the program when an error occurs.
+         * 
+         * @details Every error is collected in a single pass, and the
+         *          arguments that caused them are skipped. Neither exceptions
+         *          nor allocations are used to report errors. The '--help'
+         *          option does not print the usage message; check has() for it
+         *          instead.
+         * 
+         * @param[in]  argv   List of command line arguments.
+         * @param[out] errors The errors found. The index of each error is the
+         *                    position of its argument in argv. An error in a
+         *                    response file is at its '@file' argument.
+         * 
+         * @return The number of errors found. 0 if successful.
+         */
+        size_t parse(char** argv, errors_t& errors);
+
+        /**
+         * @brief Parse the list of arguments given on the command line, unless
+         *        the same arguments have been parsed before, with the same
+         *        options, in which case their results are loaded from a cache.
+         * 
+         * @details The cache file is named after a hash of the arguments and
+         *          of fingerprint(), so it is not used once the options
+         *          change. On a hit, the file is memory mapped, validated, and
+         *          its values are stored as they are, without being parsed or
+         *          converted again. Only values from the command line are
+         *          cached, and when response files are turned on, a command
+         *          line with a response file is never cached, as the file may
+         *          change.
+         * 
+         * @param[in] argv      List of command line arguments.
+         * @param[in] directory Directory of the cache files. It must exist.
+         * 
+         * @return true if the results were loaded from the cache. Otherwise,
+         *         parse the arguments, try to add them to the cache, and
+         *         return false.
+         */
+        bool parse_cached(char** argv, const char* directory);
+
+        /**
+         * @brief Compute a fingerprint of the option list, that changes
+         *        whenever an option string, argument type or value type does.
+         * 
+         * @return The fingerprint.
+         */
+        uint64_t fingerprint(void) const;
+
+        /**
+         * @brief Append a flat image of the results to a buffer.
+         * 
+         * @details See image_header for the layout. The image can be read in
+         *          place with results_view, or loaded with deserialize().
+         * 
+         * @param[out] out   The buffer to append to.
+         * @param[in]  layer Only results from this layer or a later one are
+         *                   included.
+         */
+        void serialize(std::string& out, layer_t layer = default_layer) const;
+
+        /**
+         * @brief Store the results of a flat image made by serialize(), with
+         *        the same layering rules as set().
+         * 
+         * @details The whole image is validated before anything is stored.
+         * 
+         * @param[in] image The image. It must start on an 8 byte boundary.
+         * 
+         * @return true if successful. Otherwise, return false, if the image is
+         *         malformed or was made for other options.
+         */
+        bool deserialize(std::string_view image);
+
+        /**
+         * @brief Clear every value, so that another command line can be
+         *        parsed with the same interface.
+         * 
+         * @details The option list, its index and the usage message are kept,
+         *          and so is the table of results, whose value lists keep
+         *          their capacity.
+         */
+        void reset(void);
+
+        /**
+         * @brief Print the command line options that have been entered, to
+         *        ensure they were read correctly.
+         */
+        void test(void);
+
+        /**
+         * @brief Set the value for the given option.
+         * 
+         * @details The value is added to those of the option, unless they come
+         *          from another layer. Values from an earlier layer are
+         *          replaced, and a value for an earlier layer is ignored.
+         * 
+         * @param[in] option An option entered in the command line.
+         * @param[in] value  The value to set for the given option.
+         * @param[in] layer  The source of the value, e.g. default_layer for
+         *                   a default value.
+         * 
+         * @return If successful, return 0. When unable to find a key for the
+         *         option, return -1. When the value cannot be converted to the
+         *         type of the option, return -2.
+         */
+        int set(std::string_view option, std::string_view value,
+                layer_t layer = command_layer);
+
+        /**
+         * @brief Load the values of a config file, in the config layer.
+         * 
+         * @details The file is read one line at a time, into a single reused
+         *          buffer, so it is never held in memory as a whole. Each line
+         *          is of the form 'key = value', where the key is that of an
+         *          option, e.g. 'jobs' for '--jobs', or only 'key' for an
+         *          option without an argument. Blank lines, and lines that
+         *          start with '#', are skipped.
+         * 
+         * @param[in] path Path of the config file.
+         * 
+         * @return If successful, return 0. When the file cannot be read,
+         *         return -1. When a line has an unknown key, or a value that
+         *         cannot be converted, skip it, load the remaining lines, and
+         *         return -2.
+         */
+        int load_config(const char* path);
+
+        /**
+         * @brief Load the values of environment variables, in the environment
+         *        layer.
+         * 
+         * @details Every option with a key is looked up once, as the prefix
+         *          followed by its key in upper case, with each '-' replaced
+         *          by '_', e.g. 'APP_DRY_RUN' for '--dry-run' with the prefix
+         *          'APP_'.
+         * 
+         * @param[in] prefix Prefix of the environment variable names.
+         * 
+         * @return If successful, return 0. When a value cannot be converted,
+         *         skip it, load the remaining variables, and return -2.
+         */
+        int load_environment(std::string_view prefix);
+
+        /**
+         * @brief Bound the size of the command lines that are parsed.
+         * 
+         * @details An argument over a limit, or a value over the limit of its
+         *          option, is an input_too_large error, and is skipped when
+         *          errors are collected.
+         * 
+         * @param[in] bounds The limits. A limit of kNoOption is off.
+         */
+        void set_limits(const limits_t& bounds);
+
+        /**
+         * @brief Retrieve the value for the given option.
+         * 
+         * @param[in] option An option entered in the command line.
+         * 
+         * @return If successful, return the value connected pertaining to the
+         *         given option. If unable to find the key for the given option,
+         *         return an empty string.
+         */
+        std::string get(std::string_view option) const;
+
+        /**
+         * @brief Retrieve the value for the given option ID.
+         * 
+         * @param[in] id An option ID, as returned by id().
+         * 
+         * @return If successful, return a view of the first value pertaining
+         *         to the option. It is valid until the option is set again.
+         *         Otherwise, return an empty string.
+         */
+        std::string_view get(optid_t id) const;
+
+        /**
+         * @brief Retrieve the converted value for the given option.
+         * 
+         * @details The value is converted once, when it is set, according to
+         *          the type of the option. Integral types are read from an
+         *          integer_value, floating point types from a floating_value or
+         *          an integer_value, and std::chrono::duration types from a
+         *          duration_value. A std::string is read with get().
+         * 
+         * @tparam    T      The type to retrieve the value as.
+         * @param[in] option An option entered in the command line.
+         * 
+         * @return If successful, return the first value pertaining to the
+         *         given option. If the option was not entered, has a
+         *         different type, or has an integer value out of the range of
+         *         an integral T, return a value initialized T.
+         */
+        template <typename T>
+        T get(std::string_view option) const;
+
+        /**
+         * @brief Retrieve the converted value for the given option ID.
+         * 
+         * @tparam    T  The type to retrieve the value as.
+         * @param[in] id An option ID, as returned by id().
+         * 
+         * @return See get<T>(std::string_view).
+         */
+        template <typename T>
+        T get(optid_t id) const;
+
+        /**
+         * @brief Check if the given option has been entered on the command
+         *        line.
+         * 
+         * @param[in] option An option entered in the command line.
+         * 
+         * @return true if the option has a value, and false if it is unable to
+         *         be found.
+         */
+        bool has(std::string_view option) const;
+
+        /**
+         * @brief Check if the option with the given ID has been entered on the
+         *        command line.
+         * 
+         * @details Only reads the bit of the option in a bitset that is kept
+         *          up to date as values are stored.
+         * 
+         * @param[in] id An option ID, as returned by id().
+         * 
+         * @return true if the option has a value, and false otherwise.
+         */
+        bool has(optid_t id) const;
+
+        /**
+         * @brief Retrieve the ID of the given option.
+         * 
+         * @details IDs are assigned when the interface is constructed, and are
+         *          the position of each option in the option list. Resolve an
+         *          ID once, and use it with has() and get() on hot paths, to
+         *          skip the string lookup.
+         * 
+         * @param[in] option An option string, or a key.
+         * 
+         * @return The ID of the option. Otherwise, return kNoOption.
+         */
+        optid_t id(std::string_view option) const;
+
+        /**
+         * @brief Take an immutable snapshot of the parse results.
+         * 
+         * @details The snapshot shares the catalog and the index of options
+         *          with the interface, and copies only the results, which are
+         *          allocated from the default memory resource. Its const
+         *          members, e.g. has() and get(), never modify it, so any
+         *          number of threads can read it at once without locking.
+         *          Publish it with a publisher, to replace it when the command
+         *          line is parsed again.
+         * 
+         * @return The snapshot.
+         */
+        std::shared_ptr<const interface> freeze(void) const;
+
+#ifdef COMMANDLINE_STATS
+        /**
+         * @brief Retrieve the statistics of the last parse, and of the values
+         *        that have been stored since.
+         * 
+         * @return The statistics.
+         */
+        const stats_t& stats(void) const
+        {
+            return this->m_stats;
+        }
+#endif
+
+    protected:
+        /**
+         * @brief Construct the command line interface, with functions that
+         *        resolve option strings in place of the built in hash tables.
+         * 
+         * @param[in] options  List of all command line options for the
+         *                     program.
+         * @param[in] lookup   Option lookup functions. These must remain valid
+         *                     for the lifetime of the interface.
+         * @param[in] resource Memory resource for the parse results.
+         */
+        interface(catalog_t options, const lookup_t* lookup,
+                  std::pmr::memory_resource* resource);
+
+    private:
+        /**
+         * @brief Shared ownership of the option list.
+         */
+        const catalog_t m_catalog;
+
+        /**
+         * @brief List of all possible options that can be supplied to the
+         *        program, i.e. the list owned by m_catalog.
+         */
+        const catalog& m_options;
+
+        /**
+         * @brief Option lookup functions, used instead of m_index and m_keys
+         *        when they are not NULL.
+         */
+        const lookup_t* m_lookup;
+
+        /**
+         * @brief Whether every option string starts with a dash, in which case
+         *        an argument that does not is never looked up.
+         */
+        bool m_dashed;
+
+        /**
+         * @brief Bounds on the size of a command line.
+         */
+        limits_t m_limits;
+
+        /**
+         * @brief The program usage message, once it has been rendered.
+         */
+        std::string m_usage;
+
+        /**
+         * @brief Path of the help file, or empty if there is none.
+         */
+        std::string m_helpfile;
+
+        /**
+         * @brief The values of every option that was supplied in the command
+         *        line, indexed by option ID.
+         * 
+         * @details There is one entry per option in m_options. An option has
+         *          been supplied when its list of values is not empty.
+         */
+        std::pmr::vector<result_t> m_results;
+
+        /**
+         * @brief Bitset of the options in m_results that have a value.
+         */
+        std::vector<uint64_t> m_present;
+
+        /**
+         * @brief Index of every short and long option string, mapped to the
+         *        position of its option struct in m_options.
+         * 
+         * @details Built once in the constructor, so that an option string can
+         *          be resolved with a single hash lookup, instead of a scan
+         *          over every option. The keys are views into m_options. It is
+         *          never modified once built, so copies share it, even across
+         *          threads. NULL when m_lookup is used instead.
+         */
+        std::shared_ptr<const strindex_t> m_index;
+
+        /**
+         * @brief Index of every key, i.e. an option string without its leading
+         *        dash(es), mapped to the position of its option struct in
+         *        m_options.
+         * 
+         * @details Long option keys take precedence over short option keys,
+         *          and are used to resolve the options given to set(), get(),
+         *          and has() when they do not start with a dash. Shared by
+         *          copies in the same way as m_index.
+         */
+        std::shared_ptr<const strindex_t> m_keys;
+
+        /**
+         * @brief Every long option string that starts with '--', sorted, so
+         *        that an abbreviation can be resolved with a binary search.
+         * 
+         * @details Built with m_index, and shared by copies in the same way.
+         *          NULL when m_lookup is used instead, in which case long
+         *          options cannot be abbreviated.
+         */
+        std::shared_ptr<const prefixes_t> m_prefixes;
+
+        /**
+         * @brief Every single character short option '-c', indexed by c, so
+         *        that a cluster of them, e.g. '-abc', is decoded one character
+         *        at a time with no lookup of a string.
+         * 
+         * @details Built with m_index, and shared by copies in the same way.
+         *          NULL when m_lookup is used instead.
+         */
+        std::shared_ptr<const shortindex_t> m_shorts;
+
+#ifdef COMMANDLINE_STATS
+        /**
+         * @brief Statistics of the last parse.
+         */
+        stats_t m_stats;
+#endif
+
+        /**
+         * @brief Build the option and key indices from m_options.
+         */
+        void index(void);
+
+        /**
+         * @brief Read the descriptions of the help file.
+         * 
+         * @param[out] help The description of each option, indexed by option
+         *                  ID. Empty for an option that is not in the file.
+         */
+        void load_help(std::vector<std::string>& help) const;
+
+        /**
+         * @brief Check every constraint of the options, in one pass over the
+         *        results.
+         * 
+         * @param[out] errors Where to add the violations. NULL to report the
+         *                    first one and exit the program.
+         */
+        void check(errors_t* errors) const;
+
+        /**
+         * @brief Report a violated constraint.
+         * 
+         * @param[out] errors Where to add the violation, or NULL to exit.
+         * @param[in]  code   The kind of violation.
+         * @param[in]  id     The option whose constraint is violated.
+         * @param[in]  other  The other option, for a constraint between
+         *                    options, or kNoOption.
+         * @param[in]  value  The offending value, if there is one.
+         */
+        void violate(errors_t* errors, errcode_t code, optid_t id,
+                     optid_t other, std::string_view value) const;
+
+        /**
+         * @brief Find the converted value of the given option ID.
+         * 
+         * @param[in] id An option ID.
+         * 
+         * @return The converted value if one is found. Otherwise, return NULL.
+         */
+        const typedval_t* find_value(optid_t id) const;
+
+        /**
+         * @brief Convert a value to the given type.
+         * 
+         * @param[in]  type   The type of the value.
+         * @param[in]  input  The string to convert.
+         * @param[out] output The converted value.
+         * 
+         * @return true if the whole string is converted, and false otherwise.
+         */
+        bool convert(value_t type, std::string_view input,
+                     typedval_t& output) const;
+
+        /**
+         * @brief Find the position of the option that has the exact given
+         *        option string.
+         * 
+         * @param[in] option The option string to search for.
+         * 
+         * @return The position of the option in m_options. Otherwise, return
+         *         kNoOption.
+         */
+        size_t find_index(std::string_view option) const;
+
+        /**
+         * @brief Find the position of the option that has the given key.
+         * 
+         * @param[in] key The key to search for.
+         * 
+         * @return The position of the option in m_options. Otherwise, return
+         *         kNoOption.
+         */
+        size_t find_key(std::string_view key) const;
+
+        /**
+         * @brief Check if the command line option struct is for the --help
+         *        option. Print usage and exit successfully if it is.
+         * 
+         * @param[in] data Command line option struct.
+         */
+        void parse_help_option(const option_info_t* data);
+
+        /**
+         * @brief Store the value of an option found in the command line. Exit
+         *        the program if the value cannot be converted to the type of
+         *        the option.
+         * 
+         * @param[in]  event  An option and its value.
+         * @param[out] errors Where to add an invalid value, instead of exiting
+         *                    the program. NULL to exit.
+         * 
+         * @note If the long option '--help' is found, and errors is NULL,
+         *       usage() will be called.
+         */
+        void parse_event(const event_t& event, errors_t* errors);
+
+        /**
+         * @brief Feed every argument after the program name to a stream, and
+         *        finish it.
+         * 
+         * @details When every option is a flag, the arguments are first tried
+         *          on parse_flags(), and only go through the stream if that
+         *          fails.
+         * 
+         * @param[in]  input  A stream that stores its events in the interface.
+         * @param[in]  argv   List of command line arguments. May be empty,
+         *                    without even the program name.
+         * @param[out] errors Where the stream adds its errors, or NULL.
+         */
+        void parse_stream(stream& input, char** argv, errors_t* errors);
+
+        /**
+         * @brief Parse a list of arguments that are all exactly a flag, without
+         *        tokenising them.
+         * 
+         * @param[in]  argv   List of arguments, after the program name.
+         * @param[out] errors Where errors are added, or NULL to exit. Only
+         *                    used to decide if a help option exits.
+         * 
+         * @return true if every argument was a flag, and was stored. Otherwise,
+         *         return false, and nothing is stored.
+         */
+        bool parse_flags(char** argv, errors_t* errors);
+
+        /**
+         * @brief Load the results for the given arguments from a cache file.
+         * 
+         * @param[in] path The cache file.
+         * @param[in] args The arguments, each followed by a NUL character.
+         * 
+         * @return true if successful. Otherwise, return false.
+         */
+        bool load_cache(const std::string& path, std::string_view args);
+
+        /**
+         * @brief Write the results for the given arguments to a cache file.
+         *        The file is replaced atomically, and failures are ignored.
+         * 
+         * @param[in] path The cache file.
+         * @param[in] args The arguments, each followed by a NUL character.
+         */
+        void store_cache(const std::string& path, std::string_view args) const;
+
+        /**
+         * @brief Write a whole buffer to a file descriptor, retrying when
+         *        interrupted.
+         * 
+         * @param[in] fd   The file descriptor.
+         * @param[in] data The buffer.
+         * 
+         * @return true if successful. Otherwise, return false.
+         */
+        static bool write_all(int fd, std::string_view data);
+
+        /**
+         * @brief Store the value for the option with the given ID.
+         * 
+         * @param[in] id    An option ID.
+         * @param[in] value The value to set for the option.
+         * @param[in] layer The source of the value.
+         * 
+         * @return See set().
+         */
+        int store(optid_t id, std::string_view value,
+                  layer_t layer = command_layer);
+
+        /**
+         * @brief Convert an option struct to its option ID.
+         * 
+         * @param[in] data An option struct in m_options, or NULL.
+         * 
+         * @return The option ID. Otherwise, return kNoOption.
+         */
+        optid_t to_id(const option_info_t* data) const;
+
+        /**
+         * @brief Find an option struct that has an option string that matches
+         *        the input string.
+         * 
+         * @param[in] option The option string to search for.
+         * 
+         * @return The option struct found, that contains the option
+         *         string. Otherwise, return NULL.
+         */
+        const option_info_t* find_option(std::string_view option) const;
+
+        /**
+         * @brief Find an option struct that has an option string that matches
+         *        the classified argument.
+         * 
+         * @param[in] token The classified argument to search for.
+         * 
+         * @return See find_option().
+         */
+        const option_info_t* find_option(const token_t& token) const;
+
+        /**
+         * @brief Type name for a range of the prefix index.
+         */
+        typedef std::pair<const prefix_t*, const prefix_t*> prefix_range_t;
+
+        /**
+         * @brief Find the option of an abbreviated long option, e.g. '--verb'
+         *        for '--verbose'.
+         * 
+         * @param[in] option The abbreviated long option, without its value.
+         * 
+         * @return The option struct whose long option is the only one that
+         *         starts with the abbreviation. Otherwise, return NULL.
+         */
+        const option_info_t* find_abbreviation(std::string_view option) const;
+
+        /**
+         * @brief Find every long option that starts with the given prefix.
+         * 
+         * @param[in] prefix The start of a long option, e.g. '--ver'.
+         * 
+         * @return The range of the prefix index that starts with the prefix,
+         *         which is empty if there is none.
+         */
+        prefix_range_t find_prefix(std::string_view prefix) const;
+
+        /**
+         * @brief Find the position of the option with the short option '-c'.
+         * 
+         * @param[in] c The character of the short option.
+         * 
+         * @return The position of the option in m_options. Otherwise, return
+         *         kNoOption.
+         */
+        size_t find_short(char c) const;
+
+        /**
+         * @brief Find the first option of a cluster of short options, e.g.
+         *        '-v' in '-vj8', for a token that is not an option itself.
+         * 
+         * @param[in] token The classified argument.
+         * 
+         * @return The option struct of the first character, if the token is
+         *         of the form '-c...' and '-c' is an option. Otherwise, return
+         *         NULL.
+         */
+        const option_info_t* find_cluster(const token_t& token) const;
+
+        /**
+         * @brief Convert an option struct to a key string. This means
+         *        '--long-option' is converted to 'long-option' and if there is
+         *        no long option, then '-short' is converted to 'short'.
+         * 
+         * @param[in] data An option struct, or NULL.
+         * 
+         * @return The key, as a view into the option list. Otherwise, return an
+         *         empty string.
+         */
+        std::string_view to_key(const option_info_t* data) const;
+
+        /**
+         * @brief Find the option struct for an option string, or for a key
+         *        string, i.e. an option string without its leading dash(es).
+         * 
+         * @param[in] input The option or key string to search for.
+         * 
+         * @return The option struct found. Otherwise, return NULL.
+         */
+        const option_info_t* to_option(std::string_view input) const;
+
+        /**
+         * @brief Check if the given option is a valid short command line
+         *        option.
+         * 
+         * @param[in] data   An option struct.
+         * @param[in] option An option string.
+         * 
+         * @return true if the input is an option, and false otherwise.
+         */
+        bool is_short_option(const option_info_t* data,
+                             std::string_view option) const;
+
+        /**
+         * @brief Check if the classified argument is a valid long command line
+         *        option.
+         * 
+         * @param[in] data  An option struct.
+         * @param[in] token A classified argument.
+         * 
+         * @return true if the input is an option, and false otherwise.
+         */
+        bool is_long_option(const option_info_t* data, const token_t& token) const;
+    };
+
+    /**
+     * @brief Type name for an immutable snapshot of a command line interface.
+     */
+    typedef std::shared_ptr<const interface> snapshot_t;
+
+    /**
+     * @brief Parse many command lines in parallel, against the same options.
+     * 
+     * @details The jobs are split into chunks, which the calling thread and
+     *          the worker threads claim one at a time from a shared counter,
+     *          so that a thread that finishes early takes more of the work.
+     *          Each job is parsed by its own copy of cli, which shares the
+     *          option list and its index, so nothing but the results is
+     *          allocated per job. Errors are collected, and never exit the
+     *          program.
+     * 
+     * @param[in]  cli     The command line interface to parse with. It is only
+     *                     read, and must not be modified during the call.
+     * @param[in]  jobs    The argv of every job.
+     * @param[out] errors  The errors of every job, at the same position as
+     *                     the job.
+     * @param[in]  threads The number of threads to use, including the calling
+     *                     one. 0 to use one per hardware thread.
+     * 
+     * @return The parse results of every job, at the same position as the job.
+     */
+    std::vector<snapshot_t> parse_batch(const interface& cli,
+                                        const std::vector<char**>& jobs,
+                                        std::vector<errors_t>& errors,
+                                        unsigned threads = 0);
+
+    /**
+     * @class publisher
+     * 
+     * @brief Holds the current snapshot of the parse results, which readers
+     *        load and writers replace atomically.
+     * 
+     * @details A reader keeps the snapshot it loaded alive for as long as it
+     *          holds it, so publishing a new snapshot, e.g. after re-parsing on
+     *          a reload, never invalidates one that is being read.
+     */
+    class publisher
+    {
+    public:
+        /**
+         * @brief Construct the publisher.
+         * 
+         * @param[in] snapshot The initial snapshot, or NULL.
+         */
+        explicit publisher(snapshot_t snapshot = snapshot_t())
+            : m_snapshot(std::move(snapshot))
+        {
+        }
+
+        /**
+         * @brief Load the current snapshot.
+         * 
+         * @return The current snapshot.
+         */
+        snapshot_t load(void) const
+        {
+#if defined(__cpp_lib_atomic_shared_ptr)
+            return this->m_snapshot.load();
+#else
+            return std::atomic_load(&this->m_snapshot);
+#endif
+        }
+
+        /**
+         * @brief Replace the current snapshot.
+         * 
+         * @param[in] snapshot The new snapshot.
+         */
+        void publish(snapshot_t snapshot)
+        {
+#if defined(__cpp_lib_atomic_shared_ptr)
+            this->m_snapshot.store(std::move(snapshot));
+#else
+            std::atomic_store(&this->m_snapshot, std::move(snapshot));
+#endif
+        }
+
+    private:
+        /**
+         * @brief The current snapshot. The free atomic functions on a
+         *        std::shared_ptr are only used before C++20, where
+         *        std::atomic<std::shared_ptr> is not available.
+         */
+#if defined(__cpp_lib_atomic_shared_ptr)
+        std::atomic<snapshot_t> m_snapshot;
+#else
+        snapshot_t m_snapshot;
+#endif
+    };
+
+    /**
+     * @class results_view
+     * 
+     * @brief Read the results in a flat image made by interface::serialize()
+     *        in place, without copying or allocating anything.
+     * 
+     * @details The views it returns point into the image, which must outlive
+     *          it. Options are resolved with the interface that the image is
+     *          checked against.
+     */
+    class results_view
+    {
+        friend class interface;
+
+    public:
+        /**
+         * @brief Construct a view of an image.
+         * 
+         * @param[in] cli   A command line interface with the same options as
+         *                  the one that made the image. It must outlive the
+         *                  view.
+         * @param[in] image The image. It must start on an 8 byte boundary.
+         */
+        results_view(const interface& cli, std::string_view image);
+
+        /**
+         * @brief Check if the image is well formed, and was made for the
+         *        options of the interface. An invalid view has no values.
+         * 
+         * @return true if the image can be read. Otherwise, return false.
+         */
+        bool valid(void) const;
+
+        /**
+         * @brief Check if the given option has a value in the image.
+         * 
+         * @param[in] option An option string, or a key.
+         * 
+         * @return true if the option has a value. Otherwise, return false.
+         */
+        bool has(std::string_view option) const;
+
+        /**
+         * @brief Check if the option with the given ID has a value in the
+         *        image.
+         * 
+         * @param[in] id An option ID.
+         * 
+         * @return true if the option has a value. Otherwise, return false.
+         */
+        bool has(optid_t id) const;
+
+        /**
+         * @brief Retrieve the first value of the given option.
+         * 
+         * @param[in] option An option string, or a key.
+         * 
+         * @return A view of the value in the image. Otherwise, return an
+         *         empty string.
+         */
+        std::string_view get(std::string_view option) const;
+
+        /**
+         * @brief Retrieve the first value of the option with the given ID.
+         * 
+         * @param[in] id An option ID.
+         * 
+         * @return See get(std::string_view).
+         */
+        std::string_view get(optid_t id) const;
+
+        /**
+         * @brief Retrieve a value of the option with the given ID.
+         * 
+         * @param[in] id An option ID.
+         * @param[in] i  Position of the value, in the order entered.
+         * 
+         * @return See get(std::string_view).
+         */
+        std::string_view get(optid_t id, size_t i) const;
+
+        /**
+         * @brief Retrieve the converted value for the given option.
+         * 
+         * @tparam    T      The type to retrieve the value as.
+         * @param[in] option An option string, or a key.
+         * 
+         * @return See interface::get<T>().
+         */
+        template <typename T>
+        T get(std::string_view option) const;
+
+        /**
+         * @brief Retrieve the converted value for the option with the given
+         *        ID.
+         * 
+         * @tparam    T  The type to retrieve the value as.
+         * @param[in] id An option ID.
+         * 
+         * @return See interface::get<T>().
+         */
+        template <typename T>
+        T get(optid_t id) const;
+
+        /**
+         * @brief Retrieve the number of values of the option with the given
+         *        ID.
+         * 
+         * @param[in] id An option ID.
+         * 
+         * @return The number of values, 0 if there is none.
+         */
+        size_t count(optid_t id) const;
+
+    private:
+        /**
+         * @brief The interface that resolves options.
+         */
+        const interface& m_cli;
+
+        /**
+         * @brief Header of the image, or NULL if it is not valid.
+         */
+        const image_header* m_header;
+
+        /**
+         * @brief Entries of the image.
+         */
+        const image_entry* m_entries;
+
+        /**
+         * @brief Values of the image.
+         */
+        const image_value* m_values;
+
+        /**
+         * @brief String pool of the image.
+         */
+        const char* m_pool;
+
+        /**
+         * @brief Find the entry of the option with the given ID.
+         * 
+         * @param[in] id An option ID.
+         * 
+         * @return The entry, or NULL if the option has no value.
+         */
+        const image_entry* find_entry(optid_t id) const;
+
+        /**
+         * @brief Retrieve a value of the image.
+         * 
+         * @param[in] i Position of the value in the image.
+         * 
+         * @return A view of the value.
+         */
+        std::string_view string(size_t i) const;
+    };
+
+    /**
+     * @class stream
+     * 
+     * @brief An incremental parser, which is fed the command line one token at
+     *        a time, in any number of chunks.
+     * 
+     * @details Each option and value is handed to a callback as soon as it is
+     *          recognised, and nothing is stored, so memory does not grow with
+     *          the number of arguments. An option that waits for an argument,
+     *          or a list_argument type option, is resolved when the next token
+     *          is fed, or when the stream is finished. This is the same parser
+     *          that interface::parse() uses.
+     * 
+     *          When response files are turned on with limits_t, a token of
+     *          the form '@file' is replaced by the arguments in the response
+     *          file, which are separated by whitespace or NUL characters. The
+     *          file is memory mapped, and its arguments are parsed in place,
+     *          without being copied.
+     */
+    class stream
+    {
+    public:
+        /**
+         * @brief Type name for the function that handles each option found.
+         */
+        typedef std::function<void(const event_t&)> callback_t;
+
+        /**
+         * @brief Construct the stream.
+         * 
+         * @param[in] cli      The command line interface, whose options are
+         *                     recognised. It must outlive the stream.
+         * @param[in] callback Function called for each option and value.
+         * @param[in] errors   Where to add the errors found, in which case the
+         *                     offending arguments are skipped. If NULL, print
+         *                     the error and exit the program instead.
+         */
+        stream(const interface& cli, callback_t callback,
+               errors_t* errors = NULL);
+
+        /**
+         * @brief Parse the next token of the command line.
+         * 
+         * @param[in] token A command line argument. It only needs to be valid
+         *                  for the duration of the call.
+         */
+        void feed(std::string_view token);
+
+        /**
+         * @brief Parse the next token of the command line, which has already
+         *        been classified.
+         * 
+         * @param[in] token A classified command line argument.
+         */
+        void feed(const token_t& token);
+
+        /**
+         * @brief Parse the next chunk of the command line.
+         * 
+         * @param[in] argv A NULL terminated list of command line arguments.
+         */
+        void feed(char** argv);
+
+        /**
+         * @brief Signal that the whole command line has been fed, and resolve
+         *        the last option, if it is still waiting for an argument.
+         */
+        void finish(void);
+
+#ifdef COMMANDLINE_STATS
+        /**
+         * @brief Retrieve the statistics of the tokens fed so far. Values are
+         *        stored by the callback, so allocations are not counted here.
+         * 
+         * @return The statistics.
+         */
+        const stats_t& stats(void) const
+        {
+            return this->m_stats;
+        }
+#endif
+
+    private:
+        /**
+         * @brief The command line interface, whose options are recognised.
+         */
+        const interface& m_cli;
+
+        /**
+         * @brief Function called for each option and value.
+         */
+        callback_t m_callback;
+
+        /**
+         * @brief Where to add the errors found, or NULL to exit the program.
+         */
+        errors_t* m_errors;
+
+        /**
+         * @brief Number of arguments fed so far, not counting those read from
+         *        response files.
+         */
+        size_t m_count;
+
+        /**
+         * @brief Number of tokens parsed so far, including those read from
+         *        response files, for the limit on tokens.
+         */
+        size_t m_tokens;
 
-    /**
-     * @brief Type name for a list of all options in a program.
-     */
-    typedef std::vector<option_t> optlist_t;
+        /**
+         * @brief Position of the argument being parsed, or of the '@file'
+         *        argument whose response file is being read.
+         */
+        size_t m_current;
 
-    /**
-     * @brief Type name for list of all entered options and their respective
-     *        values.
-     */
-    typedef std::unordered_map<std::string, std::vector<std::string>> keyval_t;
+        /**
+         * @brief A short option that was fed last, which is waiting for the
+         *        next token to see if it is an argument.
+         */
+        const option_info_t* m_pending;
 
-    /**
-     * @class interface
-     * 
-     * @brief Interface to the command line, where a user will parse command
-     *        line options, print program usage, etc.
-     */
-    class interface
-    {
-    public:
         /**
-         * @brief Construct the command line interface.
-         * 
-         * @param[in] options List of all command line options for the program.
+         * @brief Position of the pending short option.
          */
-        explicit interface(const optlist_t options);
+        size_t m_pendingindex;
 
         /**
-         * @brief Print the program usage message.
-         * 
-         * @note PROGRAM needs to be defined as a macro.
-         * @note kArgumentNameLength represents the longest name an argument can
-         *       have. Resize this in the header file if it needs to be larger.
+         * @brief The current list_argument type option, until another option
+         *        is fed.
          */
-        void usage(void);
+        const option_info_t* m_list;
 
         /**
-         * @brief Parse the list of arguments given on the command line.
-         * 
-         * @param[in] argv List of command line arguments, typically from the
-         *                 main(argc, argv) function.
+         * @brief Position of the current list option.
          */
-        void parse(char** argv);
+        size_t m_listindex;
 
         /**
-         * @brief Print the command line options that have been entered, to
-         *        ensure they were read correctly.
+         * @brief Short or long option string of the current list option.
          */
-        void test(void);
+        std::string_view m_listopt;
 
         /**
-         * @brief Set the value for the given option.
-         * 
-         * @param[in] option An option entered in the command line.
-         * @param[in] value  The value to set for the given option.
-         * 
-         * @return If successful, return 0. When unable to find a key for the
-         *         option, return -1.
+         * @brief Used to check that a list option is followed by at least one
+         *        more token.
          */
-        int set(std::string option, std::string value);
+        bool m_listempty;
 
         /**
-         * @brief Retrieve the value for the given option.
-         * 
-         * @param[in] option An option entered in the command line.
-         * 
-         * @return If successful, return the value connected pertaining to the
-         *         given option. If unable to find the key for the given option,
-         *         return an empty string.
+         * @brief Number of response files currently being read, one inside
+         *        the other.
          */
-        std::string get(std::string option);
+        size_t m_depth;
 
         /**
-         * @brief Check if the given option has been entered on the command
-         *        line.
-         * 
-         * @param[in] option An option entered in the command line.
-         * 
-         * @return true if the option is found in the hash table, and false if
-         *         it is unable to be found.
+         * @brief Device and inode of each response file currently being read,
+         *        to find one that includes itself.
          */
-        bool has(std::string option);
+        std::array<std::pair<uint64_t, uint64_t>, kResponseFileDepth> m_open;
 
-    private:
         /**
-         * @brief List of all possible options that can be supplied to the
-         *        program.
+         * @brief Number of response files read so far.
          */
-        const optlist_t m_options;
+        size_t m_files;
 
+#ifdef COMMANDLINE_STATS
         /**
-         * @brief A perfect hash table containing the options that were supplied
-         *        in the command line, and their corresponding values.
+         * @brief Statistics of the tokens fed so far.
+         */
+        stats_t m_stats;
+#endif
 
-         * @details The keys for this hash table are the option strings that are
-         *          supplied, e.g. '--long-option' or '-short', but without the
-         *          leading dash(es). Long options are used as the default key,
-         *          but if no long option exists, it falls back to the short
-         *          option.
+        /**
+         * @brief Parse every argument in a response file. Report an error if
+         *        the file cannot be read, is not a regular file, is already
+         *        being read, or if response files are nested too deeply or
+         *        there are too many of them.
+         * 
+         * @param[in] file The '@file' command line argument.
          */
-        keyval_t m_table;
+        void parse_response_file(std::string_view file);
 
         /**
          * @brief Determine if the input option is in fact a valid option.
          * 
-         * @param[out] data   Command line option struct.
-         * @param[in]  option Command line option string.
+         * @param[in] data  Command line option struct, as resolved by
+         *                  find_option().
+         * @param[in] token Command line option string.
          * 
-         * @return The option string if a valid option. Exit program otherwise.
+         * @return true if it is a valid option. Otherwise, report the error,
+         *         and return false.
          */
-        char* parse_option(const option_t** data, char* option);
+        bool parse_option(const option_info_t* data, const token_t& token);
 
         /**
-         * @brief Determine the argument type and store the corresponding value,
-         *        if the argument type takes a value.
-         * 
-         * @param[in]  data     Data structure for an option.
-         * @param[in]  argp     Argument list pointer, pointing to the
-         *                      current command line option.
-         * @param[out] listflag Used to set the list flag if a list argument
-         *                      is found.
+         * @brief Determine the argument type, and emit the option if it takes
+         *        no argument, or an argument that is part of the token.
+         *        Otherwise, wait for its argument(s).
          * 
-         * @return The pointer to the current argument in the argument list.
-         *         NULL if an error occurs.
-         * 
-         * @note If the long option '--help' is found, usage() will be called.
+         * @param[in] data  Data structure for an option.
+         * @param[in] token The current command line option.
          */
-        char** parse_argument(const option_t* data, char** argp,
-                              bool& listflag);
+        void parse_argument(const option_info_t* data, const token_t& token);
 
         /**
-         * @brief Check if the command line option struct is for the --help
-         *        option. Print usage and exit successfully if it is.
+         * @brief If a short option is waiting for an argument, determine if the
+         *        token is that argument, and emit the option.
          * 
-         * @param[in] data Command line option struct.
+         * @param[in] data  Option struct of the token, or NULL if it is not an
+         *                  option.
+         * @param[in] token The current command line argument.
+         * 
+         * @return true if the token was used as the argument. Otherwise,
+         *         return false.
          */
-        void parse_help_option(const option_t* data);
+        bool parse_short_argument(const option_info_t* data, const token_t& token);
 
         /**
-         * @brief For the given short option, determine its corresponding
-         *        argument, if there is one.
+         * @brief Decode a cluster of short options in one scan from left to
+         *        right, e.g. '-vvv' as three '-v', or '-j8' as '-j 8'.
          * 
-         * @param[in,out] argp  The argument list pointer. This will be
-         *                      incremented if there are more command line
-         *                      options after the current one.
-         * @param[out]    value The argument to the current option. If there is
-         *                      no argument, this will be an empty string.
+         * @details Options without an argument are emitted in turn. The first
+         *          option that takes an argument ends the cluster, and takes
+         *          the rest of the token as its value. If nothing is left, it
+         *          waits for the next token, as if it had been entered alone.
          * 
-         * @return The argument list pointer, properly incremented if there was
-         *         an argument following the current option.
+         * @param[in] token The current command line argument, whose first
+         *                  option was found by find_cluster().
          */
-        char** parse_short_argument(char** argp, std::string& value);
+        void parse_cluster(const token_t& token);
 
         /**
-         * @brief For the given short option, determine its corresponding
-         *        argument, if there is one.
-         * 
-         * @param[in,out] argp  The argument list pointer. This will be
-         *                      incremented if there are more command line
-         *                      options after the current one.
-         * @param[out]    key   The current option string. For long options,
-         *                      this must be extracted from the full string
-         *                      '--long-option=value'.
-         * @param[out]    value The argument to the current option. If there is
-         *                      no argument, this will be an empty string.
+         * @brief Emit a long option, with the argument extracted from the full
+         *        string '--long-option=value'.
          * 
-         * @return The argument list pointer. It is not modified throughout the
-         *         duration of the function.
+         * @param[in] data  Data structure for an option.
+         * @param[in] token The current command line option.
          */
-        char** parse_long_argument(char** argp, std::string& key,
-                                   std::string& value);
+        void parse_long_argument(const option_info_t* data, const token_t& token);
 
         /**
-         * @brief Check if there is a list argument, and if there is, store the
-         *        argument(s).
+         * @brief Check if there is a list argument, and if there is, emit it.
          * 
-         * @param[in]     argp     Argument list pointer, pointing to the
-         *                         current argument.
-         * @param[in]     option   The key used to set a value in m_table.
-         * @param[in,out] listflag A flag indicating if the previously found
-         *                         option contains list type arguments.
+         * @param[in] data  Option struct of the token, or NULL if it is not an
+         *                  option.
+         * @param[in] token The current command line argument.
          * 
-         * @return true if the previously found option has a list argument type.
+         * @return true if the token is an argument of the current list option.
          *         Otherwise, return false.
          */
-        bool parse_list_argument(char** argp, std::string option,
-                                 bool& listflag);
+        bool parse_list_argument(const option_info_t* data, const token_t& token);
 
         /**
-         * @brief Find an option struct that has an option string that matches
-         *        the input string.
-         * 
-         * @param[in] option The option string to search for.
+         * @brief Hand an option and its value to the callback.
          * 
-         * @return The option struct found, that contains the option
-         *         string. Otherwise, return NULL.
+         * @param[in] data   Data structure for an option.
+         * @param[in] option The option string as entered.
+         * @param[in] value  The value of the option.
+         * @param[in] index  Position of the argument that holds the value.
          */
-        const option_t* find_option(std::string option);
+        void emit(const option_info_t* data, std::string_view option,
+                  std::string_view value, size_t index);
 
         /**
-         * @brief Extract either the option or value from a long option string.
-         *        
-         * @param[in] option The long option string of the form
-         *                   '--long-option=value'.
-         * @param[in] field  A field of 1 means the '--long-option' section and a
-         *                   field of 2 means the 'value' section.
+         * @brief Report an error. Either add it to m_errors, or print it and
+         *        exit the program.
          * 
-         * @return The substring requested by the user. If field is an improper
-         *         value, return an empty string. If the length of the string is
-         *         iterated over and no '=' is found, return the given option
-         *         string.
+         * @param[in] code  The kind of error.
+         * @param[in] index Position of the offending argument.
+         * @param[in] token The offending argument.
          */
-        std::string extract(std::string option, int field);
+        void fail(errcode_t code, size_t index, std::string_view token);
+    };
 
+#if defined(__cpp_impl_coroutine)
+    /**
+     * @class async_stream
+     * 
+     * @brief A stream whose options and values are awaited by a C++20
+     *        coroutine, as the tokens arrive.
+     * 
+     * @details Tokens are fed as they are received, e.g. from a socket, to the
+     *          same parser as stream and interface::parse(). Each option and
+     *          value it finds is queued, with its own copy of the strings. A
+     *          coroutine awaits next() to take them one at a time, and if it is
+     *          waiting, it is resumed inside feed() or finish(). Feeding and
+     *          awaiting must then happen on the same thread, or strand, as is
+     *          the case in an event loop, and only one coroutine can await the
+     *          stream at a time.
+     * 
+     *          It is only defined when coroutines are supported, and entirely
+     *          in this header, as the library itself only requires C++17.
+     */
+    class async_stream
+    {
+    public:
         /**
-         * @brief Extract the long option section from a long option string.
+         * @class awaiter
          * 
-         * @param[in] option The long option string.
-         * 
-         * @return See extract().
+         * @brief The result of next(), which suspends the coroutine until an
+         *        option is found, or the stream is finished.
          */
-        std::string extract_option(std::string option);
+        class awaiter
+        {
+        public:
+            /**
+             * @brief Construct the awaiter.
+             * 
+             * @param[in] owner The stream that is awaited.
+             */
+            explicit awaiter(async_stream& owner) : m_owner(owner)
+            {
+            }
+
+            /**
+             * @brief Check if there is no need to suspend the coroutine.
+             */
+            bool await_ready(void) const noexcept
+            {
+                return !this->m_owner.m_queue.empty()
+                    || this->m_owner.m_finished;
+            }
+
+            /**
+             * @brief Suspend the coroutine, until the next token is fed.
+             * 
+             * @param[in] handle The coroutine that awaits the stream.
+             */
+            void await_suspend(std::coroutine_handle<> handle) noexcept
+            {
+                this->m_owner.m_waiting = handle;
+            }
+
+            /**
+             * @brief Take the next option and value.
+             * 
+             * @return The option and value, valid until the stream is awaited
+             *         again. NULL once the stream is finished and every option
+             *         has been taken.
+             */
+            const event_t* await_resume(void)
+            {
+                return this->m_owner.pop();
+            }
+
+        private:
+            /**
+             * @brief The stream that is awaited.
+             */
+            async_stream& m_owner;
+        };
 
         /**
-         * @brief Extract the value section from a long option string.
-         * 
-         * @param[in] option The long option string.
+         * @brief Construct the stream.
          * 
-         * @return See extract().
+         * @param[in] cli    The command line interface, whose options are
+         *                   recognised. It must outlive the stream.
+         * @param[in] errors Where to add the errors found, as for stream.
          */
-        std::string extract_value(std::string option);
+        explicit async_stream(const interface& cli, errors_t* errors = NULL)
+            : m_stream(cli, [this](const event_t& event)
+                  {
+                      this->m_queue.push_back({event.id,
+                                               std::string(event.option),
+                                               std::string(event.value),
+                                               event.index});
+                  }, errors),
+              m_current(),
+              m_finished(false)
+        {
+        }
+
+        async_stream(const async_stream&) = delete;
+        async_stream& operator=(const async_stream&) = delete;
 
         /**
-         * @brief Convert an option string, long or short, to a short option.
-         * 
-         * @param[in] option An option string.
+         * @brief Parse the next token of the command line, and resume the
+         *        awaiting coroutine if an option was found.
          * 
-         * @return The short option if it is found. Otherwise, return an empty
-         *         string.
+         * @param[in] token A command line argument. It only needs to be valid
+         *                  for the duration of the call.
          */
-        std::string to_short_option(std::string option);
+        void feed(std::string_view token)
+        {
+            this->m_stream.feed(token);
+            this->wake();
+        }
 
         /**
-         * @brief Convert an option string, long or short, to a long option.
-         * 
-         * @param[in] option An option string.
-         * 
-         * @return The long option if it is found. Otherwise, return an empty
-         *         string.
+         * @brief Signal that the whole command line has been fed, and resume
+         *        the awaiting coroutine.
          */
-        std::string to_long_option(std::string option);
+        void finish(void)
+        {
+            this->m_stream.finish();
+            this->m_finished = true;
+            this->wake();
+        }
 
         /**
-         * @brief Convert input option to a key string. This means
-         *        '--long-option' is converted to 'long-option' and if there is
-         *        no long option, then '-short' is converted to 'short'.
+         * @brief Await the next option and value.
          * 
-         * @param[in] input The option string to convert a key.
-         * 
-         * @return The key. Otherwise, return an empty string.
+         * @return An awaiter, whose result is the option and value, or NULL
+         *         once the stream is finished.
          */
-        std::string to_key(std::string input);
+        awaiter next(void)
+        {
+            return awaiter(*this);
+        }
 
+    private:
         /**
-         * @brief Check if the given option is a valid short or long command
-         *        line option.
-         * 
-         * @param[in] option An option string.
+         * @struct entry
          * 
-         * @return true if the input is an option, and false otherwise.
+         * @brief An option and value, which owns its strings.
          */
-        bool is_option(std::string option);
+        struct entry
+        {
+            optid_t     id;     /**< ID of the option. */
+            std::string option; /**< Option string, as it was entered. */
+            std::string value;  /**< The value. */
+            size_t      index;  /**< Position of the argument. */
+        };
 
         /**
-         * @brief Check if the given option is a valid short or long command
-         *        line option.
-         * 
-         * @param[in] data   An option struct.
-         * @param[in] option An option string.
-         * 
-         * @return true if the input is an option, and false otherwise.
+         * @brief Resume the awaiting coroutine, if there is something for it
+         *        to take.
          */
-        bool is_option(const option_t* data, std::string option);
+        void wake(void)
+        {
+            if (this->m_waiting
+                && (!this->m_queue.empty() || this->m_finished))
+            {
+                std::exchange(this->m_waiting, nullptr).resume();
+            }
+        }
 
         /**
-         * @brief Check if the given option is a valid short command line
-         *        option.
+         * @brief Take the next option and value from the queue.
+         */
+        const event_t* pop(void)
+        {
+            if (this->m_queue.empty())
+            {
+                return NULL;
+            }
+
+            this->m_entry = std::move(this->m_queue.front());
+            this->m_queue.pop_front();
+            this->m_current = {this->m_entry.id, this->m_entry.option,
+                               this->m_entry.value, this->m_entry.index};
+            return &this->m_current;
+        }
+
+        /**
+         * @brief The parser.
+         */
+        stream m_stream;
+
+        /**
+         * @brief Options and values found, and not taken yet.
+         */
+        std::deque<entry> m_queue;
+
+        /**
+         * @brief The option and value taken last, whose strings m_current
+         *        views.
+         */
+        entry m_entry;
+
+        /**
+         * @brief The option and value taken last.
+         */
+        event_t m_current;
+
+        /**
+         * @brief The coroutine that awaits the stream, if any.
+         */
+        std::coroutine_handle<> m_waiting;
+
+        /**
+         * @brief Whether the whole command line has been fed.
+         */
+        bool m_finished;
+    };
+#endif
+
+    /**
+     * @class subcommands
+     * 
+     * @brief Dispatch a command line to one of several subcommands, e.g.
+     *        'tool build ...' or 'tool run ...', each with its own options.
+     * 
+     * @details Each subcommand registers a factory for its option list, in
+     *          place of the list itself. Only the factory of the subcommand
+     *          that was entered is called, so only its interface is built and
+     *          indexed. Subcommands can be nested, by dispatching argv+1 from
+     *          another set of subcommands.
+     */
+    class subcommands
+    {
+    public:
+        /**
+         * @brief Type name for a function that builds the option list of a
+         *        subcommand.
+         */
+        typedef std::function<optlist_t(void)> factory_t;
+
+        /**
+         * @brief Register a subcommand.
          * 
-         * @param[in] option An option string.
+         * @param[in] name    The name of the subcommand, as entered.
+         * @param[in] factory Function that builds its option list. It is only
+         *                    called if the subcommand is entered.
+         * @param[in] desc    Description of the subcommand, for the usage
+         *                    message.
+         */
+        void add(std::string_view name, factory_t factory,
+                 std::string_view desc = std::string_view());
+
+        /**
+         * @brief Print the list of subcommands.
          * 
-         * @return true if the input is an option, and false otherwise.
+         * @note The program name is that of program_name().
          */
-        bool is_short_option(std::string option);
+        void usage(void) const;
 
         /**
-         * @brief Check if the given option is a valid short command line
-         *        option.
+         * @brief Build the interface of the subcommand named by argv[1], and
+         *        parse the arguments that follow it.
          * 
-         * @param[in] data   An option struct.
-         * @param[in] option An option string.
+         * @details Exit the program if no subcommand or an unknown one is
+         *          entered. If '--help', '-h' or '-?' is entered in place of a
+         *          subcommand, print the usage message and exit.
          * 
-         * @return true if the input is an option, and false otherwise.
+         * @param[in] argv List of command line arguments, typically from the
+         *                 main(argc, argv) function.
+         * 
+         * @return The interface of the subcommand, with its parse results. It
+         *         is valid until the next call to parse().
          */
-        bool is_short_option(const option_t* data, std::string option);
+        interface& parse(char** argv);
 
         /**
-         * @brief Check if the given option is a valid long command line option.
-         * 
-         * @param[in] option An option string.
+         * @brief Retrieve the name of the subcommand that was entered.
          * 
-         * @return true if the input is an option, and false otherwise.
+         * @return The name of the subcommand. Otherwise, return an empty
+         *         string, if parse() has not been called.
          */
-        bool is_long_option(std::string option);
+        std::string_view command(void) const;
+
+    private:
+        /**
+         * @brief A registered subcommand.
+         */
+        struct entry
+        {
+            std::string name;    /**< The name of the subcommand. */
+            std::string desc;    /**< Description of the subcommand. */
+            factory_t   factory; /**< Builds its option list. */
+        };
 
         /**
-         * @brief Check if the given option is a valid long command line option.
+         * @brief Every subcommand, in the order they were registered.
          * 
-         * @param[in] data   An option struct.
-         * @param[in] option An option string.
+         * @details A tool has few subcommands, and they are only searched
+         *          once per parse, so a linear search is used.
+         */
+        std::vector<entry> m_commands;
+
+        /**
+         * @brief The position of the subcommand that was entered, in
+         *        m_commands.
+         */
+        size_t m_current = kNoOption;
+
+        /**
+         * @brief The interface of the subcommand that was entered, or NULL.
+         */
+        std::unique_ptr<interface> m_interface;
+    };
+
+    /**
+     */
+    template <typename T>
+    T from_value(const typedval_t* value)
+    {
+        if (!value)
+        {
+            return T();
+        }
+
+        if constexpr (is_duration<T>::value)
+        {
+            if (auto d = std::get_if<std::chrono::nanoseconds>(value))
+            {
+                return std::chrono::duration_cast<T>(*d);
+            }
+        }
+        else if constexpr (std::is_floating_point<T>::value)
+        {
+            if (auto f = std::get_if<double>(value))
+            {
+                return static_cast<T>(*f);
+            }
+            if (auto i = std::get_if<long long>(value))
+            {
+                return static_cast<T>(*i);
+            }
+        }
+        else if constexpr (std::is_integral<T>::value)
+        {
+            /* A value out of the range of T is treated as a mismatch, rather
+             * than truncated, or wrapped to an unsigned T. */
+            if (auto i = std::get_if<long long>(value))
+            {
+                if constexpr (std::is_unsigned<T>::value)
+                {
+                    if ((*i >= 0)
+                        && (static_cast<unsigned long long>(*i)
+                            <= std::numeric_limits<T>::max()))
+                    {
+                        return static_cast<T>(*i);
+                    }
+                }
+                else if ((*i >= std::numeric_limits<T>::min())
+                         && (*i <= std::numeric_limits<T>::max()))
+                {
+                    return static_cast<T>(*i);
+                }
+            }
+        }
+        return T();
+    }
+
+    /**
+     */
+    template <typename T>
+    T interface::get(std::string_view option) const
+    {
+        return this->get<T>(this->id(option));
+    }
+
+    /**
+     */
+    template <typename T>
+    T interface::get(optid_t id) const
+    {
+        if constexpr (std::is_same<T, std::string>::value)
+        {
+            return std::string(this->get(id));
+        }
+        else
+        {
+            return from_value<T>(this->find_value(id));
+        }
+    }
+
+    /**
+     */
+    template <typename T>
+    T results_view::get(std::string_view option) const
+    {
+        return this->get<T>(this->m_cli.id(option));
+    }
+
+    /**
+     */
+    template <typename T>
+    T results_view::get(optid_t id) const
+    {
+        if constexpr (std::is_same<T, std::string>::value)
+        {
+            return std::string(this->get(id));
+        }
+        else
+        {
+            const image_entry* entry = this->find_entry(id);
+            if (!entry)
+            {
+                return T();
+            }
+
+            typedval_t value = decode_value(*entry);
+            return from_value<T>(&value);
+        }
+    }
+
+    /**
+     * @class static_index
+     * 
+     * @brief Perfect hash tables for a compile-time option list, one for the
+     *        option strings and one for the keys.
+     * 
+     * @tparam Options A compile-time option list with static storage duration.
+     */
+    template <const auto& Options>
+    class static_index
+    {
+    public:
+        /**
+         * @brief Number of options in the list.
+         */
+        static constexpr size_t kSize = std::tuple_size<
+            std::remove_cv_t<std::remove_reference_t<decltype(Options)>>>::value;
+
+        /**
+         * @brief Find the position of the option with the given option string.
+         */
+        static constexpr size_t find(std::string_view option)
+        {
+            return kOptionHash.find(option);
+        }
+
+        /**
+         * @brief Find the position of the option with the given key.
+         */
+        static constexpr size_t find_key(std::string_view key)
+        {
+            return kKeyHash.find(key);
+        }
+
+        /**
+         * @brief Find the position of the option with the short option '-c'.
+         */
+        static constexpr size_t find_short(char c)
+        {
+            return kShortIndex[static_cast<unsigned char>(c)];
+        }
+
+        /**
+         * @brief Lookup functions to hand to an interface.
+         */
+        static constexpr lookup_t kLookup{&find, &find_key, &find_short};
+
+        /**
+         * @brief Retrieve a catalog that views the option list in place.
+         */
+        static const catalog& list(void)
+        {
+            static const catalog kCatalog(kInfo.data(), kDesc.data(), kSize);
+            return kCatalog;
+        }
+
+    private:
+        /**
+         * @brief List the short and long form of every option.
+         */
+        static constexpr std::array<hash_entry, 2*kSize> options(void)
+        {
+            std::array<hash_entry, 2*kSize> entries{};
+            for (size_t i=0; i < kSize; ++i)
+            {
+                entries[2*i]   = {Options[i].shortopt, i};
+                entries[2*i+1] = {Options[i].longopt, i};
+            }
+            return entries;
+        }
+
+        /**
+         * @brief List the key of every option, i.e. the option strings without
+         *        their leading dash(es). A long option key takes precedence
+         *        over a short option key that is the same.
+         */
+        static constexpr std::array<hash_entry, 2*kSize> keys(void)
+        {
+            std::array<hash_entry, 2*kSize> entries{};
+            uint32_t hash[kSize] = {};
+            size_t   i           = 0;
+
+            for (i=0; i < kSize; ++i)
+            {
+                if (!Options[i].longopt.empty())
+                {
+                    entries[i] = {Options[i].longopt.substr(2), i};
+                    hash[i]    = fnv1a(entries[i].key, 0);
+                }
+            }
+
+            for (i=0; i < kSize; ++i)
+            {
+                if (Options[i].shortopt.empty())
+                {
+                    continue;
+                }
+
+                std::string_view key  = Options[i].shortopt.substr(1);
+                uint32_t         code = fnv1a(key, 0);
+                bool             duplicate = false;
+                for (size_t j=0; (j < kSize) && !duplicate; ++j)
+                {
+                    duplicate = ((hash[j] == code) && (entries[j].key == key));
+                }
+                if (!duplicate)
+                {
+                    entries[kSize+i] = {key, i};
+                }
+            }
+            return entries;
+        }
+
+        /**
+         * @brief Map every character c to the first option with the short
+         *        option '-c'.
+         */
+        static constexpr shortindex_t shorts(void)
+        {
+            shortindex_t table{};
+            for (size_t& entry : table)
+            {
+                entry = kNoOption;
+            }
+
+            for (size_t i=0; i < kSize; ++i)
+            {
+                std::string_view shortopt = Options[i].shortopt;
+                if ((shortopt.size() == 2) && (shortopt[0] == '-'))
+                {
+                    size_t& entry =
+                        table[static_cast<unsigned char>(shortopt[1])];
+                    entry = (entry == kNoOption) ? i : entry;
+                }
+            }
+            return table;
+        }
+
+        /**
+         * @brief Copy the part of every option needed to parse.
+         */
+        static constexpr std::array<option_info_t, kSize> info(void)
+        {
+            std::array<option_info_t, kSize> list{};
+            for (size_t i=0; i < kSize; ++i)
+            {
+                list[i] = {Options[i].shortopt, Options[i].longopt,
+                           Options[i].name, Options[i].argument,
+                           Options[i].type};
+            }
+            return list;
+        }
+
+        /**
+         * @brief Copy the description of every option.
+         */
+        static constexpr std::array<std::string_view, kSize> descs(void)
+        {
+            std::array<std::string_view, kSize> list{};
+            for (size_t i=0; i < kSize; ++i)
+            {
+                list[i] = Options[i].desc;
+            }
+            return list;
+        }
+
+        static constexpr std::array<option_info_t, kSize>    kInfo{info()};
+        static constexpr std::array<std::string_view, kSize> kDesc{descs()};
+        static constexpr perfect_hash<2*kSize> kOptionHash{options()};
+        static constexpr perfect_hash<2*kSize> kKeyHash{keys()};
+        static constexpr shortindex_t          kShortIndex{shorts()};
+    };
+
+    /**
+     * @class static_interface
+     * 
+     * @brief Interface to the command line, for an option list that is known at
+     *        compile time.
+     * 
+     * @details The option list is validated with static_assert, and option
+     *          strings are resolved with perfect hash tables that are built at
+     *          compile time, rather than hash tables built at startup.
+     * 
+     *          For example:
+     *          static constexpr commandline::static_optlist_t<1> kOptions{{
+     *              {"-h", "--help", "", commandline::no_argument, "Help."}
+     *          }};
+     *          commandline::static_interface<kOptions> cli;
+     * 
+     * @tparam Options A compile-time option list with static storage duration.
+     */
+    template <const auto& Options>
+    class static_interface : public interface
+    {
+        static_assert(has_valid_dashes(Options),
+                      "Every option needs a short option of the form '-x' or a "
+                      "long option of the form '--name', without an '='.");
+        static_assert(has_unique_options(Options),
+                      "Short and long options must be unique.");
+
+    public:
+        /**
+         * @brief Construct the command line interface.
          * 
-         * @return true if the input is an option, and false otherwise.
+         * @param[in] resource Memory resource for the parse results. It must
+         *                     outlive the interface.
          */
-        bool is_long_option(const option_t* data, std::string option);
+        explicit static_interface(std::pmr::memory_resource* resource
+                                      = std::pmr::get_default_resource())
+            : interface(catalog_t(catalog_t(), &static_index<Options>::list()),
+                        &static_index<Options>::kLookup, resource)
+        {
+        }
     };
 
 }
 
+/* Define the whole library in this header, inline, so that every program
+ * that includes it can inline the parser without a separate object file or
+ * link-time optimisation. */
+#ifdef COMMANDLINE_HEADER_ONLY
+#include "commandline-inl.hpp"
+#endif
+
 #endif /* COMMAND_LINE_HPP */
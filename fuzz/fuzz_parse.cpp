@@ -0,0 +1,113 @@
+/**
+ * @file fuzz_parse.cpp
+ * @author Gabriel Gonzalez
+ *
+ * @brief A libFuzzer target for interface::parse(), and for the results it
+ *        leaves behind.
+ *
+ * @details The input is split into arguments at each NUL or newline, and
+ *          parsed with errors collected, as a service that parses untrusted
+ *          command lines would. Response files are turned off, so that the
+ *          fuzzer cannot make it read files. Build and run it with:
+ *
+ *          clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address,undefined \
+ *              -I.. fuzz_parse.cpp ../commandline.cpp -pthread -o fuzz_parse
+ *          ./fuzz_parse -max_len=65536
+ */
+
+#include "commandline.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Build the options once, with every argument and value type, and
+ *        every kind of constraint.
+ */
+static commandline::interface& options(void)
+{
+    static commandline::interface cli = []()
+        {
+            commandline::optlist_t list = {
+                {"-v", "--verbose", "", commandline::no_argument, "Verbose."},
+                {"-q", "--quiet", "", commandline::no_argument, "Quiet."},
+                {"-j", "--jobs", "N", commandline::required_argument,
+                 "Jobs.", commandline::integer_value},
+                {"-r", "--ratio", "R", commandline::required_argument,
+                 "Ratio.", commandline::floating_value},
+                {"-t", "--timeout", "T", commandline::optional_argument,
+                 "Timeout.", commandline::duration_value},
+                {"-m", "--mode", "MODE", commandline::required_argument,
+                 "Mode."},
+                {"-i", "--input", "FILE", commandline::list_argument,
+                 "Inputs."},
+                {"", "--verify", "", commandline::no_argument, "Verify."},
+                {"-?", "--help", "", commandline::no_argument, "Help."},
+            };
+            list[0].conflicts  = {"quiet"};
+            list[2].minimum    = 1;
+            list[2].maximum    = 64;
+            list[5].choices    = {"fast", "slow"};
+            list[6].max_values = 8;
+            list[7].depends    = {"-i"};
+
+            commandline::interface parser(list);
+            commandline::limits_t  bounds;
+            bounds.response_files = 0;
+            parser.set_limits(bounds);
+            return parser;
+        }();
+    return cli;
+}
+
+/**
+ * @brief Parse one input, and read back every result.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    commandline::interface& cli = options();
+    std::string             text(reinterpret_cast<const char*>(data), size);
+    std::vector<char*>      argv;
+
+    argv.push_back(const_cast<char*>("fuzz"));
+    for (size_t start=0, i=0; i <= text.size(); ++i)
+    {
+        if ((i == text.size()) || (text[i] == '\0') || (text[i] == '\n'))
+        {
+            if (i < text.size())
+            {
+                text[i] = '\0';
+            }
+            argv.push_back(&text[start]);
+            start = i+1;
+        }
+    }
+    argv.push_back(NULL);
+
+    commandline::errors_t errors;
+    cli.reset();
+    cli.parse(argv.data(), errors);
+
+    for (commandline::optid_t id=0; id < 9; ++id)
+    {
+        if (cli.has(id))
+        {
+            (void)cli.get(id);
+        }
+    }
+    (void)cli.get<int>("jobs");
+    (void)cli.get<double>("ratio");
+
+    std::string image;
+    cli.serialize(image);
+    commandline::results_view view(cli, image);
+    if (!view.valid())
+    {
+        abort();
+    }
+
+    (void)cli.completions(text.c_str());
+    return 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file worst_case.cpp
+ * @author Gabriel Gonzalez
+ *
+ * @brief Check that interface::parse() stays linear, in time and in memory, on
+ *        the inputs that are the most expensive for it.
+ *
+ * @details Each case is parsed at a small and at an 8 times larger size. The
+ *          check fails if the time grows more than 3 times faster than the
+ *          input, or if the bytes allocated by one parse are more than a
+ *          constant per byte and per argument. Nested response files are
+ *          checked against a fixed time budget. Build and run it with:
+ *
+ *          g++ -std=c++17 -O2 -I.. worst_case.cpp ../commandline.cpp \
+ *              -pthread -o worst_case
+ *          ./worst_case
+ *
+ *          It returns 0 if every case passes, and 1 otherwise.
+ */
+
+#include "commandline.hpp"
+#include "bench/harness.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <unistd.h>
+
+/**
+ * @brief Most bytes allocated per byte of input, and per argument. Each
+ *        character of a cluster of short options can be a value of its own.
+ */
+static const size_t kBytesPerByte     = 64;
+static const size_t kBytesPerArgument = 128;
+
+/**
+ * @brief Slowest growth allowed, relative to the input, when the input is 8
+ *        times larger.
+ */
+static const double kSlack = 3.0;
+
+/**
+ * @brief A worst case, which builds a command line of a given size.
+ */
+struct worst_case
+{
+    const char*                  name;
+    std::function<void(command&, size_t)> build;
+};
+
+/**
+ * @brief Time one parse, taking the fastest of a few runs, and count the
+ *        bytes allocated by the first, before the results keep their
+ *        capacity.
+ */
+static double measure(commandline::interface& cli, command& line,
+                      size_t& bytes)
+{
+    char** argv = line.data();
+    double best = 1e30;
+    for (int run=0; run < 5; ++run)
+    {
+        commandline::errors_t errors;
+        cli.reset();
+        size_t before = allocated;
+        auto   start  = std::chrono::steady_clock::now();
+        cli.parse(argv, errors);
+        auto   stop   = std::chrono::steady_clock::now();
+        if (run == 0)
+        {
+            bytes = allocated - before;
+        }
+        best  = std::min(best,
+                         std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+/**
+ * @brief Write a response file, and return its '@path' argument.
+ */
+static std::string write_file(const std::string& path,
+                              const std::string& text)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        perror(path.c_str());
+        exit(1);
+    }
+    fputs(text.c_str(), file);
+    fclose(file);
+    return "@" + path;
+}
+
+int main(void)
+{
+    commandline::set_program_name("worst_case");
+
+    std::vector<worst_case> cases = {
+        {"equals signs", [](command& line, size_t n)
+            {
+                line.args = {"prog", std::string(n, '=')};
+            }},
+        {"long unknown option", [](command& line, size_t n)
+            {
+                line.args = {"prog", "--" + std::string(n, 'v')};
+            }},
+        {"long value", [](command& line, size_t n)
+            {
+                line.args = {"prog", "--jobs=" + std::string(n, '=')};
+            }},
+        {"list values", [](command& line, size_t n)
+            {
+                line.args = {"prog", "-i"};
+                line.args.resize(n/2 + 2, "x");
+            }},
+        {"repeated flags", [](command& line, size_t n)
+            {
+                line.args = {"prog"};
+                line.args.resize(n/3 + 1, "-v");
+            }},
+        {"short cluster", [](command& line, size_t n)
+            {
+                line.args = {"prog", "-" + std::string(n, 'v')};
+            }},
+        {"abbreviations", [](command& line, size_t n)
+            {
+                line.args = {"prog"};
+                line.args.resize(n/7 + 1, "--verb");
+            }},
+        {"ambiguous abbreviations", [](command& line, size_t n)
+            {
+                line.args = {"prog"};
+                line.args.resize(n/6 + 1, "--ver");
+            }},
+    };
+
+    commandline::interface cli(make_options());
+    commandline::limits_t  bounds;
+    bounds.response_files = commandline::kResponseFiles;
+    cli.set_limits(bounds);
+
+    size_t                 small  = 1 << 14;
+    size_t                 large  = small * 8;
+    int                    failed = 0;
+
+    for (worst_case& test : cases)
+    {
+        command lines[2];
+        size_t  bytes[2];
+        double  seconds[2];
+        size_t  sizes[2] = {small, large};
+        for (int i=0; i < 2; ++i)
+        {
+            test.build(lines[i], sizes[i]);
+            seconds[i] = measure(cli, lines[i], bytes[i]);
+        }
+
+        double ratio = seconds[1] / std::max(seconds[0], 1e-7);
+        size_t bound = kBytesPerByte * lines[1].bytes
+            + kBytesPerArgument * lines[1].args.size();
+        bool   ok    = (ratio < 8 * kSlack) && (bytes[1] <= bound);
+        printf("%-24s %10.1f us %10.1f us  x%5.1f  %10zu bytes  %s\n",
+               test.name, seconds[0] * 1e6, seconds[1] * 1e6, ratio,
+               bytes[1], ok ? "ok" : "FAILED");
+        failed += !ok;
+    }
+
+    /* A response file that includes itself, and a chain of files that each
+     * include the next one 4 times, must stop well before they expand. */
+    char directory[] = "/tmp/worst_case.XXXXXX";
+    if (!mkdtemp(directory))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    std::string base(directory);
+    std::string self = write_file(base + "/self",
+                                  "@" + base + "/self @" + base + "/self "
+                                  "@" + base + "/self @" + base + "/self\n");
+    std::string chain;
+    for (size_t i=commandline::kResponseFileDepth; i > 0; --i)
+    {
+        std::string next = (i == commandline::kResponseFileDepth) ? "-v" :
+            chain + " " + chain + " " + chain + " " + chain;
+        chain = write_file(base + "/chain" + std::to_string(i), next + "\n");
+    }
+
+    for (const std::string& file : {self, chain})
+    {
+        command line;
+        size_t  bytes;
+        line.args = {"prog", file};
+        double seconds = measure(cli, line, bytes);
+        bool   ok      = (seconds < 0.1);
+        printf("%-24s %10.1f us  %s\n", file.c_str() + base.size() + 2,
+               seconds * 1e6, ok ? "ok" : "FAILED");
+        failed += !ok;
+    }
+
+    for (size_t i=1; i <= commandline::kResponseFileDepth; ++i)
+    {
+        unlink((base + "/chain" + std::to_string(i)).c_str());
+    }
+    unlink((base + "/self").c_str());
+    rmdir(directory);
+    return failed ? 1 : 0;
+}
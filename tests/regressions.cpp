@@ -0,0 +1,191 @@
+/**
+ * @file regressions.cpp
+ * @author Gabriel Gonzalez
+ *
+ * @brief Check the behaviour of the parser on command lines that it once got
+ *        wrong, so that it does not regress.
+ *
+ * @details Every check parses a command line with errors collected, and tests
+ *          the results or the errors. Build and run it with:
+ *
+ *          g++ -std=c++17 -g -fsanitize=address,undefined -I.. \
+ *              regressions.cpp ../commandline.cpp -pthread -o regressions
+ *          ./regressions
+ *
+ *          It returns 0 if every check passes, and 1 otherwise.
+ */
+
+#include "commandline.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+/**
+ * @brief Number of checks that failed.
+ */
+static int failed = 0;
+
+/**
+ * @brief Report a check, and whether it passed.
+ */
+static void report(const char* name, bool ok)
+{
+    printf("%-52s %s\n", name, ok ? "ok" : "FAILED");
+    failed += !ok;
+}
+
+/**
+ * @brief Build the options.
+ */
+static commandline::optlist_t make_options(void)
+{
+    commandline::optlist_t options = {
+        {"-v", "--verbose", "", commandline::no_argument, "Verbose.",
+         commandline::string_value, {"quiet"}},
+        {"-q", "--quiet", "", commandline::no_argument, "Quiet."},
+        {"-j", "--jobs", "N", commandline::required_argument, "Jobs.",
+         commandline::integer_value},
+        {"-t", "--timeout", "T", commandline::required_argument, "Timeout.",
+         commandline::duration_value},
+        {"-i", "--input", "FILE", commandline::list_argument, "Inputs."},
+    };
+    return options;
+}
+
+/**
+ * @brief Errors inside a response file are reported at the position of its
+ *        '@file' argument, which is always a valid index into argv.
+ */
+static void response_file_index(void)
+{
+    char path[] = "/tmp/regressions.XXXXXX";
+    int  fd     = mkstemp(path);
+    if (fd < 0)
+    {
+        perror("mkstemp");
+        exit(1);
+    }
+
+    std::string text("-v -v -v -v -v -v -v -v --bogus -v --unknown\n");
+    bool        written = (write(fd, text.data(), text.size())
+                           == static_cast<ssize_t>(text.size()));
+    close(fd);
+
+    commandline::interface cli(make_options());
+    commandline::limits_t  bounds;
+    bounds.response_files = commandline::kResponseFiles;
+    cli.set_limits(bounds);
+
+    std::string            file = std::string("@") + path;
+    char*                  argv[] = {const_cast<char*>("prog"), &file[0],
+                                     const_cast<char*>("--bogus"), NULL};
+    commandline::errors_t  errors;
+    size_t                 count = cli.parse(argv, errors);
+    unlink(path);
+
+    bool ok = written && (count == 3) && (errors.list[0].index == 1)
+        && (errors.list[1].index == 1) && (errors.list[2].index == 2);
+    report("errors in a response file are at its argument", ok);
+}
+
+/**
+ * @brief A duration too large for a count of nanoseconds is an invalid value,
+ *        rather than an overflow.
+ */
+static void duration_overflow(void)
+{
+    commandline::interface cli(make_options());
+    bool                   ok = true;
+
+    for (const char* value : {"--timeout=99999999h", "--timeout=-99999999h",
+                              "--timeout=9223372037s",
+                              "--timeout=9223372036854775807us"})
+    {
+        char*                 argv[] = {const_cast<char*>("prog"),
+                                        const_cast<char*>(value), NULL};
+        commandline::errors_t errors;
+        cli.reset();
+        ok = ok && (cli.parse(argv, errors) == 1)
+            && (errors.list[0].code == commandline::invalid_value);
+    }
+
+    char*                 argv[] = {const_cast<char*>("prog"),
+                                    const_cast<char*>("--timeout=2562047h"),
+                                    NULL};
+    commandline::errors_t errors;
+    cli.reset();
+    ok = ok && (cli.parse(argv, errors) == 0)
+        && (cli.get<std::chrono::hours>("timeout").count() == 2562047);
+    report("durations out of range are invalid values", ok);
+}
+
+/**
+ * @brief Response files are off by default, so that an argument or a value
+ *        that starts with '@' is parsed as it is.
+ */
+static void response_files_off(void)
+{
+    commandline::interface cli(make_options());
+    char*                  argv[] = {const_cast<char*>("prog"),
+                                     const_cast<char*>("-i"),
+                                     const_cast<char*>("@bob"),
+                                     const_cast<char*>("@/etc/passwd"), NULL};
+    commandline::errors_t  errors;
+
+    bool ok = (cli.parse(argv, errors) == 0) && (cli.get("input") == "@bob");
+    report("response files are off by default", ok);
+}
+
+/**
+ * @brief A default value does not conflict with an option entered against
+ *        it, but two conflicting options entered together do.
+ */
+static void default_conflict(void)
+{
+    commandline::interface cli(make_options());
+    char*                  quiet[] = {const_cast<char*>("prog"),
+                                      const_cast<char*>("-q"), NULL};
+    char*                  both[]  = {const_cast<char*>("prog"),
+                                      const_cast<char*>("-q"),
+                                      const_cast<char*>("-v"), NULL};
+    commandline::errors_t  errors;
+
+    cli.set("verbose", "", commandline::default_layer);
+    bool ok = (cli.parse(quiet, errors) == 0) && cli.has("quiet");
+
+    cli.reset();
+    ok = ok && (cli.parse(both, errors) == 1)
+        && (errors.list[0].code == commandline::conflicting_options);
+    report("a default does not conflict with the command line", ok);
+}
+
+/**
+ * @brief An invalid value names the option it was given to.
+ */
+static void invalid_value_option(void)
+{
+    commandline::interface cli(make_options());
+    char*                  argv[] = {const_cast<char*>("prog"),
+                                     const_cast<char*>("--jobs=x"), NULL};
+    commandline::errors_t  errors;
+
+    bool ok = (cli.parse(argv, errors) == 1)
+        && (errors.list[0].code == commandline::invalid_value)
+        && (errors.list[0].index == 1)
+        && (errors.list[0].option == cli.id("jobs"));
+    report("an invalid value names its option", ok);
+}
+
+int main(void)
+{
+    commandline::set_program_name("regressions");
+
+    response_file_index();
+    response_files_off();
+    duration_overflow();
+    default_conflict();
+    invalid_value_option();
+    return failed ? 1 : 0;
+}